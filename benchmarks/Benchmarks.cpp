@@ -0,0 +1,233 @@
+// Benchmarks for PluginProcessor::processBlock and TransferFunction, written out as JSON so runs can be compared
+// across releases.
+//
+//   Benchmarks [--out <file.json>] [--seconds <min wall time per case>] [--quick]
+//
+// processBlock is measured across block sizes, sample rates, mono/stereo, curve node counts and midi notes
+// (note 0 with a 1/16 ratio is the longest period we size the ring for), each in single and double precision.
+// --quick runs a smaller grid.
+
+#include "PluginProcessor.h"
+#include <iostream>
+#include <type_traits>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<juce::Point<float>> makeCurve(int numNodes) {
+        // fixed seed so every run benchmarks the same curves
+        juce::Random random(numNodes);
+        std::vector<juce::Point<float>> nodes { { 0.0f, 0.0f }, { 1.0f, 1.0f } };
+        while ((int) nodes.size() < numNodes)
+            nodes.push_back({ random.nextFloat(), random.nextFloat() });
+        return nodes;
+    }
+
+    struct ProcessCase {
+        int blockSize;
+        double sampleRate;
+        int numChannels;
+        int numNodes;
+        int note;
+        int denominator;
+    };
+
+    // templated on the sample type so both of the processor's precisions go through the same grid
+    template <typename SampleType>
+    juce::var runProcessCase(const ProcessCase& c, double minSeconds) {
+        constexpr bool isDouble = std::is_same_v<SampleType, double>;
+        PluginProcessor processor;
+        processor.setProcessingPrecision(isDouble ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+        processor.getTF().setControlNodes(makeCurve(c.numNodes));
+        processor.getTF().waitForBandLimited();
+        if (auto* denominator = processor.parameters.getParameter("denominator"))
+            denominator->setValueNotifyingHost(processor.parameters.getParameterRange("denominator").convertTo0to1((float) c.denominator));
+
+        processor.setPlayConfigDetails(c.numChannels, c.numChannels, c.sampleRate, c.blockSize);
+        processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+        juce::AudioBuffer<SampleType> buffer(c.numChannels, c.blockSize);
+        juce::Random random(1);
+        juce::MidiBuffer midi;
+        midi.addEvent(juce::MidiMessage::noteOn(1, c.note, 1.0f), 0);
+
+        auto fillNoise = [&] {
+            for (int channel = 0; channel < c.numChannels; ++channel) {
+                auto* data = buffer.getWritePointer(channel);
+                for (int i = 0; i < c.blockSize; ++i)
+                    data[i] = static_cast<SampleType>(random.nextFloat() * 2.0f - 1.0f);
+            }
+        };
+
+        // warm up: the note on, and enough blocks for caches and the background ring growth to settle
+        juce::MidiBuffer noMidi;
+        for (int i = 0; i < 16; ++i) {
+            fillNoise();
+            processor.processBlock(buffer, i == 0 ? midi : noMidi);
+        }
+
+        juce::int64 numBlocks = 0;
+        double worstBlockNs = 0.0;
+        double totalNs = 0.0;
+
+        while (totalNs < minSeconds * 1.0e9) {
+            fillNoise();
+            auto start = Clock::now();
+            processor.processBlock(buffer, noMidi);
+            auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            totalNs += ns;
+            worstBlockNs = juce::jmax(worstBlockNs, ns);
+            ++numBlocks;
+        }
+
+        processor.releaseResources();
+
+        double nsPerSample = totalNs / (double) (numBlocks * c.blockSize);
+        double blockDurationNs = c.blockSize / c.sampleRate * 1.0e9;
+
+        auto result = new juce::DynamicObject();
+        result->setProperty("precision", isDouble ? "double" : "float");
+        result->setProperty("blockSize", c.blockSize);
+        result->setProperty("sampleRate", c.sampleRate);
+        result->setProperty("channels", c.numChannels);
+        result->setProperty("nodes", c.numNodes);
+        result->setProperty("note", c.note);
+        result->setProperty("ratio", "1/" + juce::String(c.denominator));
+        result->setProperty("blocks", numBlocks);
+        result->setProperty("nsPerSample", nsPerSample);
+        result->setProperty("realtimeFactor", blockDurationNs * (double) numBlocks / totalNs);
+        result->setProperty("worstBlockNs", worstBlockNs);
+        return juce::var(result);
+    }
+
+    template <typename Function>
+    double nsPerCall(Function&& function, int numCalls, double minSeconds) {
+        juce::int64 calls = 0;
+        double totalNs = 0.0;
+        while (totalNs < minSeconds * 1.0e9) {
+            auto start = Clock::now();
+            function();
+            totalNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            calls += numCalls;
+        }
+        return totalNs / (double) calls;
+    }
+
+    juce::var runTransferFunctionCase(int numNodes, double minSeconds) {
+        TransferFunction tf;
+        tf.setControlNodes(makeCurve(numNodes));
+        tf.waitForBandLimited();
+
+        constexpr int numPhases = 4096;
+        std::vector<double> phases(numPhases);
+        std::vector<float> depths(numPhases, 0.8f);
+        std::vector<float> syncs(numPhases, 3.0f);
+        std::vector<float> values(numPhases);
+        for (int i = 0; i < numPhases; ++i)
+            phases[(size_t) i] = i / (double) numPhases;
+
+        float sink = 0.0f;
+
+        auto getValueNs = nsPerCall([&] {
+            for (auto phase : phases)
+                sink += tf.getValue(phase, 0.8f, 3.0f);
+        },
+            numPhases,
+            minSeconds);
+
+        auto getRawValueNs = nsPerCall([&] {
+            for (auto phase : phases)
+                sink += tf.getRawValue(phase);
+        },
+            numPhases,
+            minSeconds);
+
+        auto getValuesNs = nsPerCall([&] {
+            // a 100 sample period at sync 3 sits part way down the band-limited chain
+            tf.getValues(phases.data(), depths.data(), syncs.data(), 100.0, values.data(), numPhases);
+            sink += values[0];
+        },
+            numPhases,
+            minSeconds);
+
+        // keeps the loops from being optimised away
+        static volatile float benchmarkSink;
+        benchmarkSink = sink;
+
+        auto result = new juce::DynamicObject();
+        result->setProperty("nodes", numNodes);
+        result->setProperty("getValueNs", getValueNs);
+        result->setProperty("getRawValueNs", getRawValueNs);
+        result->setProperty("getValuesNsPerSample", getValuesNs);
+        return juce::var(result);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    juce::File outputFile;
+    double minSeconds = 0.05;
+    bool quick = false;
+
+    for (int i = 0; i < args.size(); ++i) {
+        auto arg = args[i].text;
+        if (arg == "--out" && i + 1 < args.size())
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i].text);
+        else if (arg == "--seconds" && i + 1 < args.size())
+            minSeconds = juce::jmax(0.001, args[++i].text.getDoubleValue());
+        else if (arg == "--quick")
+            quick = true;
+    }
+
+    std::vector<int> blockSizes = quick ? std::vector<int> { 64, 512, 4096 } : std::vector<int> { 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    std::vector<double> sampleRates = quick ? std::vector<double> { 48000.0 } : std::vector<double> { 44100.0, 48000.0, 96000.0 };
+    std::vector<int> nodeCounts = quick ? std::vector<int> { 2, 128 } : std::vector<int> { 2, 16, 128 };
+    // note 0 at 1/16 is the worst case the ring is sized for
+    std::vector<std::pair<int, int>> notes = quick ? std::vector<std::pair<int, int>> { { 0, 16 }, { 69, 1 } } : std::vector<std::pair<int, int>> { { 0, 16 }, { 0, 1 }, { 36, 1 }, { 69, 1 }, { 100, 1 } };
+
+    juce::Array<juce::var> processResults;
+    for (auto sampleRate : sampleRates) {
+        for (int numChannels : { 1, 2 }) {
+            for (auto blockSize : blockSizes) {
+                for (auto numNodes : nodeCounts) {
+                    for (auto [note, denominator] : notes) {
+                        ProcessCase processCase { blockSize, sampleRate, numChannels, numNodes, note, denominator };
+                        for (bool isDouble : { false, true }) {
+                            auto result = isDouble ? runProcessCase<double>(processCase, minSeconds) : runProcessCase<float>(processCase, minSeconds);
+                            std::cerr << "processBlock " << (isDouble ? "double " : "float ") << sampleRate << "Hz " << numChannels << "ch block " << blockSize << " nodes " << numNodes
+                                      << " note " << note << "@1/" << denominator << ": " << (double) result["nsPerSample"] << " ns/sample\n";
+                            processResults.add(result);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    juce::Array<juce::var> transferFunctionResults;
+    for (int numNodes : { 2, 8, 32, 128, 512 })
+        transferFunctionResults.add(runTransferFunctionCase(numNodes, minSeconds));
+
+    auto root = new juce::DynamicObject();
+    root->setProperty("version", VERSION);
+    root->setProperty("buildType", CMAKE_BUILD_TYPE);
+    root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("processBlock", processResults);
+    root->setProperty("transferFunction", transferFunctionResults);
+
+    auto json = juce::JSON::toString(juce::var(root));
+    if (outputFile != juce::File()) {
+        if (!outputFile.replaceWithText(json)) {
+            std::cerr << "couldn't write " << outputFile.getFullPathName() << "\n";
+            return 1;
+        }
+    } else {
+        std::cout << json << "\n";
+    }
+
+    return 0;
+}
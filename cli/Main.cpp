@@ -0,0 +1,322 @@
+// Headless offline renderer: runs audio files through PluginProcessor with no host and no editor.
+//
+//   HorizontalDistortionRender --out <dir> [--state <file> | --curve <file>] [--note <0-127> | --midi <file.mid>]
+//                              [--param id=value ...] [--smoothing <linear|exponential>:<seconds>] [--threads <n>]
+//                              [--block-size <n>] <input files...>
+//
+// --state takes a blob saved by getStateInformation, --curve a text file with one "x y" node per line.
+// --smoothing sets how depth, sync and dry/wet glide to new values (the offline tier still glides for at least 20ms).
+// Files are spread across a thread pool, each worker owns one processor and renders whole files on it.
+
+#include "PluginProcessor.h"
+#include <atomic>
+#include <iostream>
+#include <optional>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace {
+    struct Settings {
+        juce::MemoryBlock state;
+        std::vector<juce::Point<float>> curve;
+        juce::StringPairArray parameters;
+        int note = -1;
+        juce::MidiMessageSequence midi; // timestamps in seconds
+        juce::File outputDirectory;
+        int blockSize = 512;
+        SmoothedParameter::Shape smoothingShape = SmoothedParameter::Shape::linear;
+        // below 0 leaves the processor's default
+        double smoothingSeconds = -1.0;
+    };
+
+    struct RenderResult {
+        juce::File input;
+        double audioSeconds = 0.0;
+        double wallSeconds = 0.0;
+        juce::String error;
+    };
+
+    void printUsage() {
+        std::cout << "usage: HorizontalDistortionRender --out <dir> [--state <file> | --curve <file>] [--note <0-127> | --midi <file.mid>]\n"
+                  << "                                  [--param id=value ...] [--smoothing <linear|exponential>:<seconds>] [--threads <n>]\n"
+                  << "                                  [--block-size <n>] <input files...>\n";
+    }
+
+    std::optional<std::vector<juce::Point<float>>> loadCurve(const juce::File& file) {
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        std::vector<juce::Point<float>> nodes;
+        for (auto line : lines) {
+            line = line.trim();
+            if (line.isEmpty() || line.startsWithChar('#'))
+                continue;
+
+            auto tokens = juce::StringArray::fromTokens(line, " ,\t", "");
+            tokens.removeEmptyStrings();
+            if (tokens.size() != 2)
+                return std::nullopt;
+
+            nodes.push_back({ juce::jlimit(0.0f, 1.0f, tokens[0].getFloatValue()), juce::jlimit(0.0f, 1.0f, tokens[1].getFloatValue()) });
+        }
+
+        if (nodes.size() < 2)
+            return std::nullopt;
+
+        return nodes;
+    }
+
+    std::optional<juce::MidiMessageSequence> loadMidi(const juce::File& file) {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midiFile;
+        if (!stream.openedOk() || !midiFile.readFrom(stream))
+            return std::nullopt;
+
+        midiFile.convertTimestampTicksToSeconds();
+
+        juce::MidiMessageSequence merged;
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+            merged.addSequence(*midiFile.getTrack(track), 0.0);
+
+        merged.updateMatchedPairs();
+        return merged;
+    }
+
+    void applySettings(PluginProcessor& processor, const Settings& settings) {
+        if (settings.state.getSize() > 0)
+            processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+
+        if (!settings.curve.empty())
+            processor.getTF().setControlNodes(settings.curve);
+        // the render starts right away, so don't let the first blocks go out on the exact curve
+        processor.getTF().waitForBandLimited();
+
+        for (const auto& id : settings.parameters.getAllKeys()) {
+            if (auto* parameter = processor.parameters.getParameter(id)) {
+                auto range = processor.parameters.getParameterRange(id);
+                parameter->setValueNotifyingHost(range.convertTo0to1(range.snapToLegalValue(settings.parameters[id].getFloatValue())));
+            }
+        }
+
+        if (settings.smoothingSeconds >= 0.0)
+            processor.setParameterSmoothing(settings.smoothingShape, settings.smoothingSeconds);
+    }
+
+    RenderResult renderFile(PluginProcessor& processor, const Settings& settings, const juce::File& input) {
+        RenderResult result;
+        result.input = input;
+
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+        if (reader == nullptr) {
+            result.error = "couldn't read " + input.getFullPathName();
+            return result;
+        }
+
+        auto output = settings.outputDirectory.getChildFile(input.getFileName());
+        if (output == input) {
+            result.error = "refusing to overwrite " + input.getFullPathName();
+            return result;
+        }
+
+        auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+        if (format == nullptr) {
+            result.error = "no writer for " + output.getFileExtension();
+            return result;
+        }
+
+        // the plugin takes any channel count, the reader can hand over up to 64
+        int numChannels = juce::jlimit(1, 64, static_cast<int>(reader->numChannels));
+        double sampleRate = reader->sampleRate;
+        int blockSize = settings.blockSize;
+
+        // keep the input's bit depth if the output format can take it (flac can't do 32 bit float)
+        auto bitDepths = format->getPossibleBitDepths();
+        int bitsPerSample = bitDepths.contains(static_cast<int>(reader->bitsPerSample)) ? static_cast<int>(reader->bitsPerSample) : bitDepths.getLast();
+
+        output.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(output);
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels), bitsPerSample, {}, 0));
+        if (writer == nullptr) {
+            result.error = "couldn't write " + output.getFullPathName();
+            return result;
+        }
+        stream.release(); // the writer owns it now
+
+        auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        applySettings(processor, settings);
+        // renders with the offline quality tier, same as a host bounce
+        processor.setNonRealtime(true);
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        // render past the end by the latency and drop that much from the start, so the output lines up with the input
+        auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+        auto inputLength = reader->lengthInSamples;
+        auto totalLength = inputLength + latency;
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midiBuffer;
+        int nextMidiEvent = 0;
+
+        for (juce::int64 position = 0; position < totalLength; position += blockSize) {
+            int numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize), totalLength - position));
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            block.clear();
+            // reads past the end of the file come back as silence
+            reader->read(&block, 0, numSamples, position, true, numChannels > 1);
+
+            midiBuffer.clear();
+            if (position == 0 && settings.note >= 0)
+                midiBuffer.addEvent(juce::MidiMessage::noteOn(1, settings.note, 1.0f), 0);
+
+            auto blockEnd = position + numSamples;
+            for (; nextMidiEvent < settings.midi.getNumEvents(); ++nextMidiEvent) {
+                const auto& message = settings.midi.getEventPointer(nextMidiEvent)->message;
+                auto eventSample = static_cast<juce::int64>(message.getTimeStamp() * sampleRate);
+                if (eventSample >= blockEnd)
+                    break;
+                midiBuffer.addEvent(message, static_cast<int>(juce::jmax(static_cast<juce::int64>(0), eventSample - position)));
+            }
+
+            processor.processBlock(block, midiBuffer);
+
+            auto skip = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(numSamples), latency - position));
+            if (numSamples > skip)
+                writer->writeFromAudioSampleBuffer(block, skip, numSamples - skip);
+        }
+
+        processor.releaseResources();
+        writer.reset();
+
+        result.audioSeconds = static_cast<double>(inputLength) / sampleRate;
+        result.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    Settings settings;
+    juce::Array<juce::File> inputs;
+    int numThreads = juce::jmax(1, juce::SystemStats::getNumCpus());
+
+    for (int i = 0; i < args.size(); ++i) {
+        auto arg = args[i].text;
+        auto next = [&]() -> juce::String { return i + 1 < args.size() ? args[++i].text : juce::String(); };
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--out") {
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        } else if (arg == "--state") {
+            auto file = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            if (!file.loadFileAsData(settings.state)) {
+                std::cerr << "couldn't read state " << file.getFullPathName() << "\n";
+                return 1;
+            }
+        } else if (arg == "--curve") {
+            auto file = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            auto curve = loadCurve(file);
+            if (!curve) {
+                std::cerr << "couldn't read curve " << file.getFullPathName() << " (expected one \"x y\" node per line, at least two)\n";
+                return 1;
+            }
+            settings.curve = *curve;
+        } else if (arg == "--note") {
+            settings.note = juce::jlimit(0, 127, next().getIntValue());
+        } else if (arg == "--midi") {
+            auto file = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            auto midi = loadMidi(file);
+            if (!midi) {
+                std::cerr << "couldn't read midi " << file.getFullPathName() << "\n";
+                return 1;
+            }
+            settings.midi = *midi;
+        } else if (arg == "--param") {
+            auto assignment = next();
+            settings.parameters.set(assignment.upToFirstOccurrenceOf("=", false, false), assignment.fromFirstOccurrenceOf("=", false, false));
+        } else if (arg == "--smoothing") {
+            auto value = next();
+            auto shape = value.upToFirstOccurrenceOf(":", false, false);
+            if ((shape != "linear" && shape != "exponential") || !value.contains(":")) {
+                std::cerr << "--smoothing takes linear:<seconds> or exponential:<seconds>\n";
+                return 1;
+            }
+            settings.smoothingShape = shape == "linear" ? SmoothedParameter::Shape::linear : SmoothedParameter::Shape::exponential;
+            settings.smoothingSeconds = juce::jmax(0.0, value.fromFirstOccurrenceOf(":", false, false).getDoubleValue());
+        } else if (arg == "--threads") {
+            numThreads = juce::jmax(1, next().getIntValue());
+        } else if (arg == "--block-size") {
+            settings.blockSize = juce::jlimit(16, 65536, next().getIntValue());
+        } else if (arg.startsWith("-")) {
+            std::cerr << "unknown option " << arg << "\n";
+            printUsage();
+            return 1;
+        } else {
+            inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+        }
+    }
+
+    if (inputs.isEmpty() || settings.outputDirectory == juce::File()) {
+        printUsage();
+        return 1;
+    }
+
+    if (!settings.outputDirectory.createDirectory()) {
+        std::cerr << "couldn't create " << settings.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    numThreads = juce::jmin(numThreads, inputs.size());
+
+    // one processor per worker, made here so nothing gets constructed off the main thread
+    std::vector<std::unique_ptr<PluginProcessor>> processors;
+    for (int i = 0; i < numThreads; ++i)
+        processors.push_back(std::make_unique<PluginProcessor>());
+
+    std::vector<RenderResult> results(static_cast<size_t>(inputs.size()));
+    std::atomic<int> nextInput { 0 };
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(numThreads);
+        for (int worker = 0; worker < numThreads; ++worker) {
+            pool.addJob([&, worker] {
+                for (int index = nextInput++; index < inputs.size(); index = nextInput++)
+                    results[static_cast<size_t>(index)] = renderFile(*processors[static_cast<size_t>(worker)], settings, inputs[index]);
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(10);
+    }
+
+    auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double totalAudioSeconds = 0.0;
+    int failures = 0;
+
+    for (const auto& result : results) {
+        if (result.error.isNotEmpty()) {
+            std::cerr << "failed: " << result.error << "\n";
+            ++failures;
+            continue;
+        }
+
+        totalAudioSeconds += result.audioSeconds;
+        std::cout << result.input.getFileName() << ": " << juce::String(result.audioSeconds, 2) << "s of audio in "
+                  << juce::String(result.wallSeconds, 2) << "s (" << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.wallSeconds), 1) << "x realtime)\n";
+    }
+
+    std::cout << "rendered " << (int) results.size() - failures << " of " << (int) results.size() << " files on " << numThreads << " threads: "
+              << juce::String(totalAudioSeconds, 2) << "s of audio in " << juce::String(wallSeconds, 2) << "s ("
+              << juce::String(totalAudioSeconds / juce::jmax(1.0e-9, wallSeconds), 1) << "x realtime)\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,438 @@
+// Golden output regression check: renders a fixed set of inputs, curves and settings through PluginProcessor and
+// compares them against reference files rendered by a known good build. Run it before and after touching the dsp.
+//
+//   GoldenOutput record [--dir <references>]                    render every case and overwrite its reference
+//   GoldenOutput compare [--dir <references>] [--exact | --snr <dB>] [--case <name>]
+//
+// compare prints one line per case and exits non-zero if any of them diverged or has no reference.
+// The default tolerance is an snr of 120dB against the reference, --exact wants every sample bit identical.
+
+#include "PluginProcessor.h"
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace {
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int NUM_CHANNELS = 2;
+    constexpr int LENGTH_SAMPLES = 24000;
+    constexpr double TEMPO_BPM = 120.0;
+
+    enum class Signal { sweep, impulses, noise };
+    enum class Curve { identity, triangle, random };
+
+    struct NoteEvent {
+        int sample;
+        int note;
+        bool on;
+    };
+
+    // a parameter moved partway through, applied at the start of the block the sample falls in
+    struct ParameterChange {
+        int sample;
+        const char* id;
+        float value;
+    };
+
+    struct GoldenCase {
+        juce::String name;
+        Signal signal;
+        Curve curve;
+        float depth;
+        float sync;
+        float dryWet;
+        int numerator;
+        int denominator;
+        int interpolation;
+        bool polyphony;
+        std::vector<NoteEvent> notes;
+        int blockSize = 256;
+        std::vector<ParameterChange> changes = {};
+        // -1 leaves the oversampling parameters at their defaults
+        int oversampling = -1;
+        int oversamplingFilter = 0;
+        // 0 or more turns tempo sync on with that division, following a transport rolling at TEMPO_BPM
+        int tempoDivision = -1;
+        bool doublePrecision = false;
+        // renders like a host bounce, with the offline quality profile
+        bool offline = false;
+    };
+
+    // a transport rolling from the top of the song, for the tempo synced cases
+    class Transport : public juce::AudioPlayHead {
+    public:
+        juce::int64 position = 0;
+
+        juce::Optional<PositionInfo> getPosition() const override {
+            PositionInfo info;
+            info.setBpm(TEMPO_BPM);
+            info.setTimeSignature(TimeSignature { 4, 4 });
+            info.setTimeInSamples(position);
+            info.setPpqPosition(static_cast<double>(position) / SAMPLE_RATE * TEMPO_BPM / 60.0);
+            info.setIsPlaying(true);
+            return info;
+        }
+    };
+
+    // the same case with one setting changed, for the paths the default render doesn't go through
+    template <typename Change>
+    GoldenCase variant(GoldenCase c, const juce::String& name, Change&& change) {
+        c.name = name;
+        change(c);
+        return c;
+    }
+
+    std::vector<GoldenCase> getCases() {
+        // the inputs cover the whole band (sweep), transients (impulses) and dense material (noise), the settings
+        // cover each interpolator, high sync, ratios, polyphony and notes landing mid block
+        std::vector<GoldenCase> cases {
+            { "sweep_identity", Signal::sweep, Curve::identity, 1.0f, 1.0f, 1.0f, 1, 1, 0, false, {} },
+            { "sweep_triangle", Signal::sweep, Curve::triangle, 1.0f, 1.0f, 1.0f, 1, 1, 0, false, {} },
+            { "sweep_random_note36", Signal::sweep, Curve::random, 0.5f, 1.0f, 1.0f, 1, 1, 0, false, { { 0, 36, true } } },
+            { "sweep_random_sync8", Signal::sweep, Curve::random, 1.0f, 8.0f, 1.0f, 1, 1, 1, false, { { 0, 48, true } } },
+            { "sweep_triangle_sync32", Signal::sweep, Curve::triangle, 1.0f, 32.0f, 0.7f, 1, 1, 3, false, { { 0, 60, true } } },
+            { "impulses_triangle_hermite", Signal::impulses, Curve::triangle, 1.0f, 2.0f, 1.0f, 1, 1, 1, false, { { 0, 57, true } } },
+            { "impulses_random_lagrange", Signal::impulses, Curve::random, 0.8f, 1.0f, 1.0f, 3, 4, 2, false, { { 0, 45, true } } },
+            { "impulses_random_sinc", Signal::impulses, Curve::random, 1.0f, 4.0f, 1.0f, 1, 1, 3, false, { { 0, 69, true } } },
+            { "impulses_lowest_note", Signal::impulses, Curve::triangle, 1.0f, 1.0f, 1.0f, 1, 16, 0, false, { { 0, 0, true } } },
+            { "noise_triangle_ratio", Signal::noise, Curve::triangle, 1.0f, 1.0f, 1.0f, 5, 3, 0, false, { { 0, 40, true } } },
+            { "noise_random_halfwet", Signal::noise, Curve::random, 1.0f, 3.0f, 0.5f, 1, 1, 1, false, { { 0, 52, true } } },
+            { "noise_note_changes", Signal::noise, Curve::random, 1.0f, 1.0f, 1.0f, 1, 1, 0, false,
+                { { 0, 48, true }, { 4001, 48, false }, { 4001, 55, true }, { 12345, 60, true }, { 12345, 55, false } }, 97 },
+            { "noise_poly_chord", Signal::noise, Curve::triangle, 1.0f, 2.0f, 1.0f, 1, 1, 1, true,
+                { { 0, 48, true }, { 100, 52, true }, { 250, 55, true }, { 16000, 52, false } } },
+            { "noise_poly_legato", Signal::noise, Curve::random, 0.7f, 1.0f, 1.0f, 2, 3, 2, true,
+                { { 0, 40, true }, { 6000, 47, true }, { 6000, 40, false }, { 18000, 47, false } }, 333 },
+        };
+
+        // then the paths the live default skips, as variations on a few of the cases above
+        const auto aliasing = cases[3];
+        const auto halfWet = cases[10];
+        const auto chord = cases[12];
+
+        // each oversampling setting, bar the default already covered
+        for (int factor = 0; factor < OversamplingSettings::NUM_FACTORS; ++factor) {
+            for (int filter = 0; filter < OversamplingSettings::NUM_FILTERS; ++filter) {
+                if (factor == 2 && filter == 0)
+                    continue;
+                cases.push_back(variant(aliasing, aliasing.name + "_os" + juce::String(1 << factor) + (filter == 0 ? "_iir" : "_linear"), [&](auto& c) {
+                    c.oversampling = factor;
+                    c.oversamplingFilter = filter;
+                }));
+            }
+        }
+
+        // a quality change mid render crossfades between oversamplers, an interpolation change between kernels
+        cases.push_back(variant(aliasing, "sweep_random_switches", [](auto& c) {
+            c.changes = { { 6000, "oversampling", 3.0f }, { 12000, "interpolation", 3.0f }, { 18000, "oversampling", 0.0f } };
+        }));
+
+        // the double precision path, mono and polyphonic
+        cases.push_back(variant(aliasing, "sweep_random_sync8_double", [](auto& c) { c.doublePrecision = true; }));
+        cases.push_back(variant(chord, "noise_poly_chord_double", [](auto& c) { c.doublePrecision = true; }));
+
+        // tempo synced to a rolling transport, a sixteenth and a dotted quarter at a 2/3 ratio
+        cases.push_back({ "impulses_triangle_tempo16th", Signal::impulses, Curve::triangle, 1.0f, 1.0f, 1.0f, 1, 1, 1, false, {} });
+        cases.back().tempoDivision = 11;
+        cases.push_back({ "noise_random_tempo_dotted", Signal::noise, Curve::random, 1.0f, 2.0f, 1.0f, 2, 3, 2, false, {}, 160 });
+        cases.back().tempoDivision = 6;
+
+        // dry/wet parked at 0 from the start goes straight to the bypass delay, and going in and out of it
+        // mid render crossfades with the wet path
+        cases.push_back(variant(halfWet, "noise_random_bypassed", [](auto& c) { c.dryWet = 0.0f; }));
+        cases.push_back(variant(halfWet, "noise_random_bypass_in_out", [](auto& c) {
+            c.changes = { { 5000, "dryWet", 0.0f }, { 15000, "dryWet", 1.0f } };
+        }));
+
+        // rendered like a bounce, with the offline quality profile
+        cases.push_back(variant(aliasing, "sweep_random_sync8_offline", [](auto& c) { c.offline = true; }));
+        cases.push_back(variant(chord, "noise_poly_chord_offline", [](auto& c) { c.offline = true; }));
+
+        return cases;
+    }
+
+    void fillSignal(juce::AudioBuffer<float>& buffer, Signal signal) {
+        buffer.clear();
+        juce::Random random(42);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            float left = 0.0f;
+            float right = 0.0f;
+
+            switch (signal) {
+                case Signal::sweep: {
+                    // exponential 20Hz to 20kHz, right channel a quarter period behind
+                    double duration = buffer.getNumSamples() / SAMPLE_RATE;
+                    double k = std::log(20000.0 / 20.0);
+                    double t = i / SAMPLE_RATE;
+                    double phase = juce::MathConstants<double>::twoPi * 20.0 * duration / k * (std::exp(t / duration * k) - 1.0);
+                    left = 0.5f * static_cast<float>(std::sin(phase));
+                    right = 0.5f * static_cast<float>(std::cos(phase));
+                    break;
+                }
+                case Signal::impulses:
+                    left = i % 1000 == 0 ? 1.0f : 0.0f;
+                    right = i % 1000 == 500 ? -1.0f : 0.0f;
+                    break;
+                case Signal::noise:
+                    left = random.nextFloat() * 2.0f - 1.0f;
+                    right = random.nextFloat() * 2.0f - 1.0f;
+                    break;
+            }
+
+            buffer.setSample(0, i, left);
+            buffer.setSample(1, i, right);
+        }
+    }
+
+    std::vector<juce::Point<float>> makeCurve(Curve curve) {
+        switch (curve) {
+            case Curve::identity:
+                return { { 0.0f, 0.0f }, { 1.0f, 1.0f } };
+            case Curve::triangle:
+                return { { 0.0f, 0.0f }, { 0.5f, 1.0f }, { 1.0f, 0.0f } };
+            case Curve::random:
+                break;
+        }
+
+        juce::Random random(7);
+        std::vector<juce::Point<float>> nodes { { 0.0f, 0.2f }, { 1.0f, 0.8f } };
+        for (int i = 0; i < 14; ++i)
+            nodes.push_back({ random.nextFloat(), random.nextFloat() });
+        return nodes;
+    }
+
+    void setParameter(PluginProcessor& processor, const juce::String& id, float value) {
+        if (auto* parameter = processor.parameters.getParameter(id))
+            parameter->setValueNotifyingHost(processor.parameters.getParameterRange(id).convertTo0to1(value));
+    }
+
+    juce::AudioBuffer<float> render(const GoldenCase& c) {
+        PluginProcessor processor;
+        Transport transport;
+        processor.getTF().setControlNodes(makeCurve(c.curve));
+        // otherwise how much of the render used the exact curve would depend on the background thread
+        processor.getTF().waitForBandLimited();
+        setParameter(processor, "depth", c.depth);
+        setParameter(processor, "sync", c.sync);
+        setParameter(processor, "dryWet", c.dryWet);
+        setParameter(processor, "numerator", static_cast<float>(c.numerator));
+        setParameter(processor, "denominator", static_cast<float>(c.denominator));
+        setParameter(processor, "interpolation", static_cast<float>(c.interpolation));
+        setParameter(processor, "polyphony", c.polyphony ? 1.0f : 0.0f);
+        if (c.oversampling >= 0) {
+            setParameter(processor, "oversampling", static_cast<float>(c.oversampling));
+            setParameter(processor, "oversamplingFilter", static_cast<float>(c.oversamplingFilter));
+        }
+        if (c.tempoDivision >= 0) {
+            setParameter(processor, "tempoSync", 1.0f);
+            setParameter(processor, "tempoDivision", static_cast<float>(c.tempoDivision));
+            processor.setPlayHead(&transport);
+        }
+
+        processor.setNonRealtime(c.offline);
+        processor.setProcessingPrecision(c.doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+        processor.setPlayConfigDetails(NUM_CHANNELS, NUM_CHANNELS, SAMPLE_RATE, c.blockSize);
+        processor.prepareToPlay(SAMPLE_RATE, c.blockSize);
+
+        juce::AudioBuffer<float> audio(NUM_CHANNELS, LENGTH_SAMPLES);
+        fillSignal(audio, c.signal);
+        // the double path renders a copy and hands it back as float, the references are float either way
+        juce::AudioBuffer<double> doubleAudio;
+        if (c.doublePrecision)
+            doubleAudio.makeCopyOf(audio);
+
+        juce::MidiBuffer midi;
+        for (int position = 0; position < LENGTH_SAMPLES; position += c.blockSize) {
+            int numSamples = juce::jmin(c.blockSize, LENGTH_SAMPLES - position);
+            transport.position = position;
+
+            for (const auto& change : c.changes) {
+                if (change.sample >= position && change.sample < position + numSamples)
+                    setParameter(processor, change.id, change.value);
+            }
+
+            midi.clear();
+            for (const auto& event : c.notes) {
+                if (event.sample >= position && event.sample < position + numSamples) {
+                    auto message = event.on ? juce::MidiMessage::noteOn(1, event.note, 1.0f) : juce::MidiMessage::noteOff(1, event.note);
+                    midi.addEvent(message, event.sample - position);
+                }
+            }
+
+            if (c.doublePrecision) {
+                juce::AudioBuffer<double> block(doubleAudio.getArrayOfWritePointers(), NUM_CHANNELS, position, numSamples);
+                processor.processBlock(block, midi);
+            } else {
+                juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), NUM_CHANNELS, position, numSamples);
+                processor.processBlock(block, midi);
+            }
+        }
+
+        processor.releaseResources();
+        if (c.doublePrecision)
+            audio.makeCopyOf(doubleAudio);
+        return audio;
+    }
+
+    bool writeReference(const juce::File& file, const juce::AudioBuffer<float>& audio) {
+        file.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(file);
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), SAMPLE_RATE, NUM_CHANNELS, 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+        stream.release(); // the writer owns it now
+
+        return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    }
+
+    bool readReference(const juce::File& file, juce::AudioBuffer<float>& audio) {
+        // the wav reader doesn't take a null stream, so a missing file has to be caught here
+        auto stream = file.existsAsFile() ? file.createInputStream() : nullptr;
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(stream.release(), true));
+        if (reader == nullptr || !reader->usesFloatingPointData || reader->numChannels != NUM_CHANNELS)
+            return false;
+
+        audio.setSize(NUM_CHANNELS, static_cast<int>(reader->lengthInSamples));
+        return reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+    }
+
+    struct Comparison {
+        bool passed = false;
+        double snr = 0.0; // dB, infinite when identical
+        float maxError = 0.0f;
+        int firstDivergence = -1;
+    };
+
+    Comparison compare(const juce::AudioBuffer<float>& rendered, const juce::AudioBuffer<float>& reference, bool exact, double minSnr) {
+        Comparison result;
+        if (rendered.getNumSamples() != reference.getNumSamples())
+            return result;
+
+        double signalEnergy = 0.0;
+        double errorEnergy = 0.0;
+
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel) {
+            const auto* a = rendered.getReadPointer(channel);
+            const auto* b = reference.getReadPointer(channel);
+            for (int i = 0; i < rendered.getNumSamples(); ++i) {
+                // compare bit patterns so nans and -0 count as differences too
+                if (std::memcmp(&a[i], &b[i], sizeof(float)) != 0 && (result.firstDivergence < 0 || i < result.firstDivergence))
+                    result.firstDivergence = i;
+
+                auto error = static_cast<double>(a[i]) - b[i];
+                signalEnergy += static_cast<double>(b[i]) * b[i];
+                errorEnergy += error * error;
+                result.maxError = juce::jmax(result.maxError, static_cast<float>(std::abs(error)));
+            }
+        }
+
+        result.snr = errorEnergy > 0.0 ? 10.0 * std::log10(signalEnergy / errorEnergy) : std::numeric_limits<double>::infinity();
+        result.passed = exact ? result.firstDivergence < 0 : (result.snr >= minSnr && std::isfinite(result.maxError));
+        return result;
+    }
+
+    void printUsage() {
+        std::cout << "usage: GoldenOutput record [--dir <references>]\n"
+                  << "       GoldenOutput compare [--dir <references>] [--exact | --snr <dB>] [--case <name>]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || (args[0].text != "record" && args[0].text != "compare")) {
+        printUsage();
+        return 1;
+    }
+
+    bool recording = args[0].text == "record";
+    juce::File directory(GOLDEN_REFERENCE_DIR);
+    bool exact = false;
+    double minSnr = 120.0;
+    juce::String onlyCase;
+
+    for (int i = 1; i < args.size(); ++i) {
+        auto arg = args[i].text;
+        auto next = [&]() -> juce::String { return i + 1 < args.size() ? args[++i].text : juce::String(); };
+
+        if (arg == "--dir")
+            directory = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--exact")
+            exact = true;
+        else if (arg == "--snr")
+            minSnr = next().getDoubleValue();
+        else if (arg == "--case")
+            onlyCase = next();
+        else {
+            std::cerr << "unknown option " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (recording && !directory.createDirectory()) {
+        std::cerr << "couldn't create " << directory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    int numCases = 0;
+    int failures = 0;
+
+    for (const auto& c : getCases()) {
+        if (onlyCase.isNotEmpty() && c.name != onlyCase)
+            continue;
+
+        ++numCases;
+        auto file = directory.getChildFile(c.name + ".wav");
+        auto rendered = render(c);
+
+        if (recording) {
+            if (!writeReference(file, rendered)) {
+                std::cerr << c.name << ": couldn't write " << file.getFullPathName() << "\n";
+                ++failures;
+            } else {
+                std::cout << c.name << ": recorded\n";
+            }
+            continue;
+        }
+
+        juce::AudioBuffer<float> reference;
+        if (!readReference(file, reference)) {
+            std::cout << c.name << ": FAILED, no usable reference at " << file.getFullPathName() << "\n";
+            ++failures;
+            continue;
+        }
+
+        auto result = compare(rendered, reference, exact, minSnr);
+        if (!result.passed)
+            ++failures;
+
+        std::cout << c.name << ": " << (result.passed ? "ok" : "FAILED");
+        if (reference.getNumSamples() != rendered.getNumSamples())
+            std::cout << ", reference is " << reference.getNumSamples() << " samples, rendered " << rendered.getNumSamples();
+        else if (result.firstDivergence >= 0)
+            std::cout << ", snr " << juce::String(result.snr, 1) << "dB, max error " << result.maxError << ", first differs at sample " << result.firstDivergence;
+        else
+            std::cout << ", bit exact";
+        std::cout << "\n";
+    }
+
+    if (numCases == 0) {
+        std::cerr << "no case called " << onlyCase << "\n";
+        return 1;
+    }
+
+    if (recording)
+        std::cout << "recorded " << numCases - failures << " of " << numCases << " cases\n";
+    else
+        std::cout << numCases - failures << " of " << numCases << " cases match " << (exact ? "bit exact" : "to " + juce::String(minSnr, 1) + "dB snr") << "\n";
+    return failures == 0 ? 0 : 1;
+}
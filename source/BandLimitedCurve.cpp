@@ -0,0 +1,118 @@
+#include "BandLimitedCurve.h"
+#include <algorithm>
+#include <cmath>
+
+BandLimitedCurve::BandLimitedCurve()
+    : tables(static_cast<size_t>(NUM_LEVELS * (TABLE_SIZE + 1)), 0.0f),
+      coefficients(static_cast<size_t>(MAX_HARMONICS + 1)),
+      sum(static_cast<size_t>(TABLE_SIZE)) {
+}
+
+const std::vector<double>& BandLimitedCurve::getCosines() {
+    static const std::vector<double> cosines = [] {
+        std::vector<double> values(static_cast<size_t>(TABLE_SIZE));
+        for (int i = 0; i < TABLE_SIZE; ++i)
+            values[static_cast<size_t>(i)] = std::cos(juce::MathConstants<double>::twoPi * i / TABLE_SIZE);
+        return values;
+    }();
+    return cosines;
+}
+
+double BandLimitedCurve::getLevelPosition(double cyclesPerSample) {
+    // level l keeps MAX_HARMONICS >> l harmonics, which all fit below nyquist once that many cycles
+    // per sample is at most 0.5, so from log2(2 * MAX_HARMONICS * cyclesPerSample) up. getValues() blends
+    // floor(position) with the level above, so the position is one level past that and both levels fit
+    if (cyclesPerSample <= 0.0)
+        return -1.0;
+
+    double position = std::log2(4.0 * MAX_HARMONICS * cyclesPerSample);
+    return juce::jlimit(-1.0, static_cast<double>(NUM_LEVELS - 1), position);
+}
+
+void BandLimitedCurve::addPiece(double x1, double x2, double slope, double intercept) {
+    // what's left of the curve once the ramp is taken out, f(x) = intercept + slope * x
+    slope -= rise;
+    coefficients[0] += (x2 - x1) * (intercept + slope * (x1 + x2) * 0.5);
+
+    // the integral of f(x) e^(-iwx) is (slope / w^2 + i f(x) / w) e^(-iwx)
+    auto antiderivative = [&](double x, double w) {
+        std::complex<double> scale(slope / (w * w), (intercept + slope * x) / w);
+        return scale * std::polar(1.0, -w * x);
+    };
+
+    for (int harmonic = 1; harmonic <= MAX_HARMONICS; ++harmonic) {
+        double w = juce::MathConstants<double>::twoPi * harmonic;
+        coefficients[static_cast<size_t>(harmonic)] += antiderivative(x2, w) - antiderivative(x1, w);
+    }
+}
+
+void BandLimitedCurve::addClampedPiece(double x1, double x2, double slope, double intercept) {
+    // a rising piece crosses 0 before 1, a falling one the other way round, so the splits come out in order
+    double splits[4] = { x1 };
+    int numSplits = 1;
+    if (slope != 0.0) {
+        for (double edge : { slope > 0.0 ? 0.0 : 1.0, slope > 0.0 ? 1.0 : 0.0 }) {
+            double crossing = (edge - intercept) / slope;
+            if (crossing > x1 && crossing < x2)
+                splits[numSplits++] = crossing;
+        }
+    }
+    splits[numSplits++] = x2;
+
+    for (int i = 0; i + 1 < numSplits; ++i) {
+        double start = splits[i];
+        double end = splits[i + 1];
+        double middle = intercept + slope * (start + end) * 0.5;
+        if (middle < 0.0)
+            addPiece(start, end, 0.0, 0.0);
+        else if (middle > 1.0)
+            addPiece(start, end, 0.0, 1.0);
+        else
+            addPiece(start, end, slope, intercept);
+    }
+}
+
+void BandLimitedCurve::build(const SegmentTable& table, int newGeneration) {
+    std::fill(coefficients.begin(), coefficients.end(), std::complex<double>());
+
+    bool first = true;
+    double startValue = 0.0;
+    double endValue = 0.0;
+    table.forEachPiece([&](double x1, double x2, double slope, double intercept) {
+        if (first)
+            startValue = juce::jlimit(0.0, 1.0, intercept + slope * x1);
+        first = false;
+        endValue = juce::jlimit(0.0, 1.0, intercept + slope * x2);
+    });
+    rise = static_cast<float>(endValue - startValue);
+
+    table.forEachPiece([this](double x1, double x2, double slope, double intercept) {
+        addClampedPiece(x1, x2, slope, intercept);
+    });
+
+    // from the fewest harmonics up, each level being the one after it plus the band in between
+    const auto& cosines = getCosines();
+    constexpr int mask = TABLE_SIZE - 1;
+    std::fill(sum.begin(), sum.end(), coefficients[0].real());
+
+    int harmonic = 1;
+    for (int level = NUM_LEVELS - 1; level >= 0; --level) {
+        for (int top = MAX_HARMONICS >> level; harmonic <= top; ++harmonic) {
+            // 2 re(c e^(i theta)), with sin(theta) read as cos(theta - pi / 2)
+            double re = 2.0 * coefficients[static_cast<size_t>(harmonic)].real();
+            double im = 2.0 * coefficients[static_cast<size_t>(harmonic)].imag();
+            for (int i = 0; i < TABLE_SIZE; ++i) {
+                int index = harmonic * i;
+                sum[static_cast<size_t>(i)] += re * cosines[static_cast<size_t>(index & mask)]
+                                               - im * cosines[static_cast<size_t>((index - TABLE_SIZE / 4) & mask)];
+            }
+        }
+
+        float* values = tables.data() + level * (TABLE_SIZE + 1);
+        for (int i = 0; i < TABLE_SIZE; ++i)
+            values[i] = static_cast<float>(sum[static_cast<size_t>(i)]);
+        values[TABLE_SIZE] = values[0];
+    }
+
+    generation = newGeneration;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SegmentTable.h"
+#include <complex>
+#include <vector>
+
+// the curve as a chain of band-limited wavetables for when it repeats fast enough to alias. level 0 keeps the
+// first MAX_HARMONICS harmonics and each level after it keeps half as many, down to just the fundamental.
+// a curve that ends higher than it starts jumps back at the wrap, so the tables hold the curve minus a ramp
+// with the same rise and evaluate() adds the ramp back exactly. that way an identity curve at sync 1 still
+// cancels against the phase instead of picking up ripple at the wrap
+class BandLimitedCurve {
+public:
+    static constexpr int TABLE_SIZE = 4096;
+    static constexpr int MAX_HARMONICS = 1024;
+    static constexpr int NUM_LEVELS = 11;
+
+    // allocates - every level starts flat at 0
+    BandLimitedCurve();
+
+    // not audio thread - doesn't allocate. the harmonics come from the fourier series of each straight piece,
+    // worked out exactly, so the corners don't alias on the way in
+    void build(const SegmentTable& table, int newGeneration);
+
+    // which setControlNodes() call this was built from
+    int getGeneration() const { return generation; }
+
+    // where in the chain a curve repeating this many times per sample should read from, blending the level
+    // below it with the one above. every harmonic in both is under nyquist. below 0 even level 0 cuts
+    // harmonics that would fit, so the exact curve is the better answer there
+    static double getLevelPosition(double cyclesPerSample);
+
+    // x in [0, 1), level in [0, NUM_LEVELS)
+    float evaluate(int level, double x) const {
+        const float* values = tables.data() + level * (TABLE_SIZE + 1);
+        double position = x * TABLE_SIZE;
+        int index = static_cast<int>(position);
+        float frac = static_cast<float>(position - index);
+        return rise * static_cast<float>(x) + values[index] + frac * (values[index + 1] - values[index]);
+    }
+
+private:
+    // NUM_LEVELS tables of TABLE_SIZE + 1, the last entry repeating the first so interpolation needn't wrap
+    std::vector<float> tables;
+    // scratch for build(), sized once
+    std::vector<std::complex<double>> coefficients;
+    std::vector<double> sum;
+    // how much higher the curve ends than it starts, taken out as a ramp before the series
+    float rise = 0.0f;
+    int generation = 0;
+
+    void addPiece(double x1, double x2, double slope, double intercept);
+    // calls addPiece() for each part of a piece either side of where evaluate()'s clamp kicks in
+    void addClampedPiece(double x1, double x2, double slope, double intercept);
+
+    static const std::vector<double>& getCosines();
+};
@@ -10,6 +10,7 @@ CurveShapeEditor::CurveShapeEditor(PluginProcessor& processor)
         pushUndoState();
         nodes = { { 0.0f, 0.0f }, { 1.0f, 1.0f } };
         syncNodesToCurve();
+        invalidateCurve();
         repaint();
     };
 
@@ -19,6 +20,7 @@ CurveShapeEditor::CurveShapeEditor(PluginProcessor& processor)
     addMouseListener(this, false);
     setWantsKeyboardFocus(true);
     syncNodesFromCurve();
+    curveXs.reserve(512);
 
     startTimerHz(30);
 }
@@ -30,15 +32,14 @@ CurveShapeEditor::~CurveShapeEditor() {
 void CurveShapeEditor::paint(juce::Graphics& g) {
     g.fillAll(Palette::base);
 
-    g.setColour(Palette::surface0);
-    g.fillRect(canvasArea);
-    g.setColour(Palette::overlay0);
-    g.drawRect(canvasArea, 2);
-
-    if (isShiftHeld)
-        drawGrid(g);
+    float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (!curveLayerValid || scale != curveLayerScale)
+        renderCurveLayer(scale, canvasArea);
+    else if (!dirtyCurveArea.isEmpty())
+        renderCurveLayer(scale, dirtyCurveArea);
+    dirtyCurveArea = {};
+    g.drawImage(curveLayer, canvasArea.toFloat());
 
-    drawWaveform(g);
     drawNodes(g);
 
     g.setColour(Palette::text);
@@ -57,40 +58,135 @@ void CurveShapeEditor::resized() {
     phaseOverlay->setBounds(canvasArea);
 
     resetButton.setBounds(area.withTrimmedTop(10).removeFromLeft(area.getWidth() / 6 - 5));
+    invalidateCurve();
+}
+
+void CurveShapeEditor::renderCurveLayer(float scale, juce::Rectangle<int> area) {
+    int width = juce::jmax(1, juce::roundToInt(canvasArea.getWidth() * scale));
+    int height = juce::jmax(1, juce::roundToInt(canvasArea.getHeight() * scale));
+    if (curveLayer.getWidth() != width || curveLayer.getHeight() != height) {
+        curveLayer = juce::Image(juce::Image::ARGB, width, height, true);
+        area = canvasArea;
+    }
+
+    curveLayerScale = scale;
+    curveLayerValid = true;
+
+    // only the pixels under area are redrawn, everything else keeps what's already there
+    auto pixels = ((area - canvasArea.getPosition()).toFloat() * scale).getSmallestIntegerContainer().expanded(1).getIntersection(curveLayer.getBounds());
+    if (pixels.isEmpty())
+        return;
+    curveLayer.clear(pixels);
+
+    // drawn in our own coordinates, so the usual helpers work unchanged
+    juce::Graphics g(curveLayer);
+    g.reduceClipRegion(pixels);
+    g.addTransform(juce::AffineTransform::translation((float) -canvasArea.getX(), (float) -canvasArea.getY()).scaled(scale));
+
+    g.setColour(Palette::surface0);
+    g.fillRect(canvasArea);
+    g.setColour(Palette::overlay0);
+    g.drawRect(canvasArea, 2);
+
+    if (isShiftHeld)
+        drawGrid(g);
+
+    // read once here rather than through the processor's atomics for every point. a partial redraw keeps
+    // what the rest of the layer was drawn with, if they've moved since the timer redraws the lot
+    if (area.contains(canvasArea)) {
+        drawnDepth = processorRef.getDepth();
+        drawnSync = processorRef.getSync();
+    }
+    drawWaveform(g, area);
 }
 
-void CurveShapeEditor::drawWaveform(juce::Graphics& g) {
+void CurveShapeEditor::drawWaveform(juce::Graphics& g, juce::Rectangle<int> area) {
     if (nodes.size() < 2)
         return;
 
-    std::vector<float> xPositions;
+    const auto& tf = processorRef.getTF();
+
+    curveXs.clear();
 
     const int numSamples = 256;
     for (int i = 0; i <= numSamples; ++i) {
-        xPositions.push_back(i / (float) numSamples);
+        curveXs.push_back(i / (float) numSamples);
     }
 
     for (const auto& node : nodes) {
-        xPositions.push_back(node.x);
+        curveXs.push_back(node.x);
     }
 
-    std::sort(xPositions.begin(), xPositions.end());
-    xPositions.erase(std::unique(xPositions.begin(), xPositions.end()), xPositions.end());
-
-    juce::Path path;
-    for (size_t i = 0; i < xPositions.size(); ++i) {
-        float phase = xPositions[i];
-        float value = processorRef.getCurveValue(phase);
+    std::sort(curveXs.begin(), curveXs.end());
+    curveXs.erase(std::unique(curveXs.begin(), curveXs.end()), curveXs.end());
+
+    // just the points under area, plus a couple either side so the stroke's ends fall outside it
+    float fromPhase = screenToPoint(area.getTopLeft().toFloat()).x;
+    float toPhase = screenToPoint(area.getBottomRight().toFloat()).x;
+    int first = (int) (std::lower_bound(curveXs.begin(), curveXs.end(), fromPhase) - curveXs.begin());
+    int last = (int) (std::upper_bound(curveXs.begin(), curveXs.end(), toPhase) - curveXs.begin());
+    first = juce::jmax(0, first - 2);
+    last = juce::jmin((int) curveXs.size(), last + 2);
+
+    curvePath.clear();
+    for (int i = first; i < last; ++i) {
+        float phase = curveXs[(size_t) i];
+        float value = tf.getValue(phase, drawnDepth, drawnSync);
         auto point = pointToScreen(phase, value);
 
-        if (i == 0)
-            path.startNewSubPath(point);
+        if (i == first)
+            curvePath.startNewSubPath(point);
         else
-            path.lineTo(point);
+            curvePath.lineTo(point);
     }
 
     g.setColour(Palette::pink);
-    g.strokePath(path, juce::PathStrokeType(2.5f));
+    g.strokePath(curvePath, juce::PathStrokeType(2.5f));
+}
+
+juce::Rectangle<int> CurveShapeEditor::getNodeBounds(juce::Point<float> node) {
+    // a selected node's radius plus its outline
+    auto centre = pointToScreen(node.x, node.y);
+    return juce::Rectangle<float>(centre.x - 9.0f, centre.y - 9.0f, 18.0f, 18.0f).getSmallestIntegerContainer();
+}
+
+juce::Rectangle<int> CurveShapeEditor::getNodeCountBounds() const {
+    return { canvasArea.getX() + 5, canvasArea.getY() + 5, 100, 20 };
+}
+
+void CurveShapeEditor::repaintAroundNode(int index, juce::Point<float> previousPosition) {
+    auto node = nodes[(size_t) index];
+    float left = juce::jmin(node.x, previousPosition.x);
+    float right = juce::jmax(node.x, previousPosition.x);
+
+    // moving a node only reshapes the curve out to its neighbours. the first segment also carries on past
+    // both ends of the curve, and sync repeats the whole thing across the canvas, so those redraw it all
+    float leftNeighbour = 0.0f;
+    float rightNeighbour = 1.0f;
+    int numBefore = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if ((int) i == index)
+            continue;
+        if (nodes[i].x < left)
+            ++numBefore;
+        if (nodes[i].x <= left)
+            leftNeighbour = juce::jmax(leftNeighbour, nodes[i].x);
+        if (nodes[i].x >= right)
+            rightNeighbour = juce::jmin(rightNeighbour, nodes[i].x);
+    }
+
+    auto area = canvasArea;
+    if (numBefore >= 2 && drawnSync == 1.0f) {
+        auto from = pointToScreen(leftNeighbour, 0.0f);
+        auto to = pointToScreen(rightNeighbour, 0.0f);
+        area = juce::Rectangle<int>::leftTopRightBottom((int) from.x, canvasArea.getY(), (int) std::ceil(to.x), canvasArea.getBottom()).expanded(10, 0).getIntersection(canvasArea);
+    }
+
+    dirtyCurveArea = dirtyCurveArea.getUnion(area);
+    repaint(area);
+
+    repaint(getNodeBounds(previousPosition));
+    repaint(getNodeBounds(node));
 }
 
 void CurveShapeEditor::drawGrid(juce::Graphics& g) {
@@ -138,7 +234,8 @@ void CurveShapeEditor::mouseDown(const juce::MouseEvent& event) {
         dragStartPosition = pos;
         isDragging = true;
         hasDragMoved = false;
-        repaint();
+        repaintAroundNode(selectedNodeIndex, pos);
+        repaint(getNodeCountBounds());
     } else if (selectedNodeIndex != -1) {
         if (selectedNodeIndex >= 0 && selectedNodeIndex < (int) nodes.size()) {
             dragStartPosition = nodes[selectedNodeIndex];
@@ -167,9 +264,13 @@ void CurveShapeEditor::mouseDrag(const juce::MouseEvent& event) {
         }
     }
 
+    auto previousPosition = nodes[selectedNodeIndex];
+    if (pos == previousPosition)
+        return;
+
     nodes[selectedNodeIndex] = pos;
     syncNodesToCurve();
-    repaint();
+    repaintAroundNode(selectedNodeIndex, previousPosition);
 }
 
 void CurveShapeEditor::mouseUp(const juce::MouseEvent& event) {
@@ -178,10 +279,15 @@ void CurveShapeEditor::mouseUp(const juce::MouseEvent& event) {
             pushUndoState();
             nodes.erase(nodes.begin() + selectedNodeIndex);
             syncNodesToCurve();
+            invalidateCurve();
             repaint();
         }
     }
 
+    // the node drops back to its unselected size
+    if (selectedNodeIndex >= 0 && selectedNodeIndex < (int) nodes.size())
+        repaint(getNodeBounds(nodes[(size_t) selectedNodeIndex]));
+
     isDragging = false;
     hasDragMoved = false;
     selectedNodeIndex = -1;
@@ -190,8 +296,11 @@ void CurveShapeEditor::mouseUp(const juce::MouseEvent& event) {
 void CurveShapeEditor::mouseMove(const juce::MouseEvent& event) {
     int newHovered = findNodeAtPosition(event.position.toFloat());
     if (newHovered != hoveredNodeIndex) {
+        if (hoveredNodeIndex >= 0 && hoveredNodeIndex < (int) nodes.size())
+            repaint(getNodeBounds(nodes[(size_t) hoveredNodeIndex]));
+        if (newHovered >= 0)
+            repaint(getNodeBounds(nodes[(size_t) newHovered]));
         hoveredNodeIndex = newHovered;
-        repaint();
     }
 }
 
@@ -199,7 +308,8 @@ void CurveShapeEditor::modifierKeysChanged(const juce::ModifierKeys& modifiers)
     bool newShiftState = modifiers.isShiftDown();
     if (newShiftState != isShiftHeld) {
         isShiftHeld = newShiftState;
-        repaint();
+        invalidateCurve();
+        repaint(canvasArea);
     }
 }
 
@@ -211,12 +321,14 @@ bool CurveShapeEditor::keyPressed(const juce::KeyPress& key) {
             if (modifiers.isShiftDown()) {
                 if (canRedo()) {
                     redo();
+                    invalidateCurve();
                     repaint();
                     return true;
                 }
             } else {
                 if (canUndo()) {
                     undo();
+                    invalidateCurve();
                     repaint();
                     return true;
                 }
@@ -248,7 +360,7 @@ void CurveShapeEditor::drawNodes(juce::Graphics& g) {
 
     g.setColour(Palette::text);
     g.setFont(12.0f);
-    g.drawText(juce::String(nodes.size()) + " nodes", canvasArea.getX() + 5, canvasArea.getY() + 5, 100, 20, juce::Justification::left, false);
+    g.drawText(juce::String(nodes.size()) + " nodes", getNodeCountBounds(), juce::Justification::left, false);
 }
 
 void CurveShapeEditor::drawNode(juce::Graphics& g, size_t index, juce::Point<float> pos, bool isSelected, bool isHovered) {
@@ -293,11 +405,13 @@ juce::Point<float> CurveShapeEditor::snapToGrid(juce::Point<float> pos) {
 }
 
 void CurveShapeEditor::syncNodesFromCurve() {
-    nodes = processorRef.getTF().nodes().read();
+    nodes = processorRef.getTF().getControlNodes();
+    nodeGeneration = processorRef.getTF().getNodeGeneration();
 }
 
 void CurveShapeEditor::syncNodesToCurve() {
     processorRef.getTF().setControlNodes(nodes);
+    nodeGeneration = processorRef.getTF().getNodeGeneration();
 }
 
 void CurveShapeEditor::pushUndoState() {
@@ -335,5 +449,22 @@ void CurveShapeEditor::redo() {
 }
 
 void CurveShapeEditor::timerCallback() {
-    repaint();
+    // a preset or the host restoring state can swap the curve while we're open. whatever we were
+    // in the middle of was on the old nodes, so drop it
+    if (processorRef.getTF().getNodeGeneration() != nodeGeneration) {
+        syncNodesFromCurve();
+        selectedNodeIndex = -1;
+        hoveredNodeIndex = -1;
+        isDragging = false;
+        hasDragMoved = false;
+        invalidateCurve();
+        repaint();
+        return;
+    }
+
+    // the host can move depth and sync at any time too
+    if (processorRef.getDepth() != drawnDepth || processorRef.getSync() != drawnSync) {
+        invalidateCurve();
+        repaint(canvasArea);
+    }
 }
@@ -7,15 +7,18 @@
 class CurveShapeEditor;
 
 //==============================================================================
-class PhaseIndicatorOverlay : public juce::Component, private juce::Timer {
+// the playhead cursor. the audio thread only says where the oscillator is once per block, so between blocks
+// we carry the phase on at the frequency it reported, once per screen refresh. while the oscillator is
+// stopped, or the audio thread has gone quiet, the refresh callback is dropped and we wait for the processor
+// to say it's started again. hidden, we do neither
+class PhaseIndicatorOverlay : public juce::Component, private juce::ChangeListener {
 public:
     explicit PhaseIndicatorOverlay(PluginProcessor& processor)
         : processorRef(processor) {
-        startTimerHz(30);
     }
 
     ~PhaseIndicatorOverlay() override {
-        stopTimer();
+        processorRef.removePhaseStartListener(this);
     }
 
     void setCanvasArea(juce::Rectangle<int> area) {
@@ -25,20 +28,28 @@ public:
 private:
     PluginProcessor& processorRef;
     juce::Rectangle<int> canvasArea;
+    std::unique_ptr<juce::VBlankAttachment> vBlank;
+
+    static constexpr float DISC_RADIUS = 8.0f;
+    // where we last put the cursor. paint() draws exactly this, so what's on screen matches the
+    // regions we marked dirty
+    float cursorX = 0.0f;
+    float cursorY = 0.0f;
+    juce::Rectangle<int> cursorBounds;
+
+    juce::Rectangle<int> getCursorBounds() const {
+        int margin = (int) std::ceil(DISC_RADIUS) + 2;
+        return juce::Rectangle<int>((int) cursorX - margin, 0, margin * 2 + 1, getHeight());
+    }
 
     void paint(juce::Graphics& g) override {
-        double phase = processorRef.getPhase();
-        float y = processorRef.getCurveValue(phase);
-
-        float localX = (float) phase * getWidth();
-        float localY = getHeight() - y * getHeight();
-
-        localY = juce::jlimit(0.0f, (float) getHeight(), localY);
+        float localX = cursorX;
+        float localY = cursorY;
 
         g.setColour(Palette::yellow.withAlpha(0.7f));
         g.drawVerticalLine((int) localX, 0.0f, (float) getHeight());
 
-        const float discRadius = 8.0f;
+        const float discRadius = DISC_RADIUS;
 
         g.setColour(Palette::text);
         g.drawEllipse(localX - discRadius, localY - discRadius, discRadius * 2, discRadius * 2, 2.0f);
@@ -52,10 +63,89 @@ private:
         return false;
     }
 
-    void timerCallback() override {
+    void resized() override {
         repaint();
     }
 
+    void visibilityChanged() override {
+        updateRunning();
+    }
+
+    void parentHierarchyChanged() override {
+        updateRunning();
+    }
+
+    void updateRunning() {
+        if (!isShowing()) {
+            vBlank.reset();
+            processorRef.removePhaseStartListener(this);
+        } else if (vBlank == nullptr) {
+            start();
+        }
+    }
+
+    void changeListenerCallback(juce::ChangeBroadcaster*) override {
+        if (isShowing() && vBlank == nullptr)
+            start();
+    }
+
+    // follows the oscillator once per refresh while it moves, otherwise waits to hear that it's started
+    void start() {
+        if (!update()) {
+            processorRef.addPhaseStartListener(this);
+            return;
+        }
+
+        processorRef.removePhaseStartListener(this);
+        vBlank = std::make_unique<juce::VBlankAttachment>(this, [this] {
+            if (update())
+                return;
+
+            // nothing moving, nothing to draw every frame. deleting the attachment from inside its own
+            // callback isn't safe, so leave that for the message loop
+            juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<PhaseIndicatorOverlay>(this)] {
+                if (safeThis != nullptr && safeThis->vBlank != nullptr && safeThis->isStopped()) {
+                    safeThis->vBlank.reset();
+                    safeThis->processorRef.addPhaseStartListener(safeThis);
+                }
+            });
+        });
+    }
+
+    bool isStopped() {
+        return !processorRef.getPhaseSnapshot().isMoving(juce::Time::getMillisecondCounterHiRes());
+    }
+
+    // moves the cursor to where the oscillator should be by now, repainting only the strips under the old and
+    // new cursor. false when it's stopped, the cursor then sits where the audio thread last left it
+    bool update() {
+        auto snapshot = processorRef.getPhaseSnapshot();
+        double nowMs = juce::Time::getMillisecondCounterHiRes();
+        double elapsedMs = nowMs - snapshot.timeMs;
+        bool running = snapshot.isMoving(nowMs);
+
+        double phase = snapshot.phase;
+        if (running) {
+            phase += snapshot.frequency * juce::jmax(0.0, elapsedMs) * 0.001;
+            phase -= std::floor(phase);
+        }
+
+        float y = processorRef.getCurveValue((float) phase);
+        float newX = (float) phase * getWidth();
+        float newY = juce::jlimit(0.0f, (float) getHeight(), getHeight() - y * getHeight());
+
+        if (newX != cursorX || newY != cursorY || cursorBounds.isEmpty()) {
+            cursorX = newX;
+            cursorY = newY;
+            auto newBounds = getCursorBounds();
+            repaint(cursorBounds);
+            repaint(newBounds);
+            cursorBounds = newBounds;
+        }
+
+        return running;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PhaseIndicatorOverlay)
 };
 
@@ -84,11 +174,27 @@ private:
 
     juce::TextButton resetButton { "Reset" };
 
+    // the canvas, grid and curve drawn once at the screen's pixel scale and reused until the nodes, depth,
+    // sync, size or grid change. paint() only blits it and draws the nodes on top
+    juce::Image curveLayer;
+    bool curveLayerValid = false;
+    // dragging a node only redraws this much of the layer, the stretch of curve out to its neighbours
+    juce::Rectangle<int> dirtyCurveArea;
+    float curveLayerScale = 1.0f;
+    // what the curve layer was drawn with
+    float drawnDepth = 0.0f;
+    float drawnSync = 1.0f;
+    // reused so rebuilding the curve doesn't allocate
+    std::vector<float> curveXs;
+    juce::Path curvePath;
+
     std::unique_ptr<PhaseIndicatorOverlay> phaseOverlay;
 
     juce::Rectangle<int> canvasArea;
 
     std::vector<juce::Point<float>> nodes;
+    // the transfer function's node generation that nodes matches, anything newer came from somewhere else
+    int nodeGeneration = 0;
 
     std::vector<std::vector<juce::Point<float>>> undoStack;
     std::vector<std::vector<juce::Point<float>>> redoStack;
@@ -110,7 +216,12 @@ private:
     void redo();
     bool canUndo() const { return !undoStack.empty(); }
     bool canRedo() const { return !redoStack.empty(); }
-    void drawWaveform(juce::Graphics& g);
+    void invalidateCurve() { curveLayerValid = false; }
+    void renderCurveLayer(float scale, juce::Rectangle<int> area);
+    void repaintAroundNode(int index, juce::Point<float> previousPosition);
+    juce::Rectangle<int> getNodeBounds(juce::Point<float> node);
+    juce::Rectangle<int> getNodeCountBounds() const;
+    void drawWaveform(juce::Graphics& g, juce::Rectangle<int> area);
     void drawGrid(juce::Graphics& g);
     void drawNodes(juce::Graphics& g);
     void drawNode(juce::Graphics& g, size_t index, juce::Point<float> screenPos, bool isSelected, bool isHovered);
@@ -0,0 +1,129 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(__amd64__) || (defined(_M_IX86_FP) && _M_IX86_FP == 2)
+    #include <emmintrin.h>
+    #define HD_FLOAT4_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define HD_FLOAT4_NEON 1
+    // 32 bit arm has no double lanes
+    #if defined(__aarch64__) || defined(_M_ARM64)
+        #define HD_DOUBLE4_NEON 1
+    #endif
+#endif
+
+// four floats in a register, just the handful of ops the delay kernel needs.
+// juce::dsp::SIMDRegister only does aligned loads and changes width with AVX, and our loads are
+// unaligned reads of two interleaved stereo frames so we want exactly four lanes
+struct Float4 {
+#if HD_FLOAT4_SSE
+    __m128 v;
+
+    static Float4 load(const float* p) { return { _mm_loadu_ps(p) }; }
+    // { a, a, b, b } - one coefficient per stereo frame
+    static Float4 pairs(float a, float b) { return { _mm_setr_ps(a, a, b, b) }; }
+    static Float4 zero() { return { _mm_setzero_ps() }; }
+
+    Float4 operator+(Float4 other) const { return { _mm_add_ps(v, other.v) }; }
+    Float4 operator*(Float4 other) const { return { _mm_mul_ps(v, other.v) }; }
+
+    // folds the two frames together, leaving { lanes 0 + 2, lanes 1 + 3 } in left and right
+    void sumFrames(float& left, float& right) const {
+        __m128 folded = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        left = _mm_cvtss_f32(folded);
+        right = _mm_cvtss_f32(_mm_shuffle_ps(folded, folded, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+#elif HD_FLOAT4_NEON
+    float32x4_t v;
+
+    static Float4 load(const float* p) { return { vld1q_f32(p) }; }
+    static Float4 pairs(float a, float b) { return { vcombine_f32(vdup_n_f32(a), vdup_n_f32(b)) }; }
+    static Float4 zero() { return { vdupq_n_f32(0.0f) }; }
+
+    Float4 operator+(Float4 other) const { return { vaddq_f32(v, other.v) }; }
+    Float4 operator*(Float4 other) const { return { vmulq_f32(v, other.v) }; }
+
+    void sumFrames(float& left, float& right) const {
+        float32x2_t folded = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        left = vget_lane_f32(folded, 0);
+        right = vget_lane_f32(folded, 1);
+    }
+#else
+    float v[4];
+
+    static Float4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    static Float4 pairs(float a, float b) { return { { a, a, b, b } }; }
+    static Float4 zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+
+    Float4 operator+(Float4 other) const { return { { v[0] + other.v[0], v[1] + other.v[1], v[2] + other.v[2], v[3] + other.v[3] } }; }
+    Float4 operator*(Float4 other) const { return { { v[0] * other.v[0], v[1] * other.v[1], v[2] * other.v[2], v[3] * other.v[3] } }; }
+
+    void sumFrames(float& left, float& right) const {
+        left = v[0] + v[2];
+        right = v[1] + v[3];
+    }
+#endif
+};
+
+// the same four lanes in double precision for the 64 bit path, two registers wide on sse2 and neon
+struct Double4 {
+#if HD_FLOAT4_SSE
+    __m128d lo, hi;
+
+    static Double4 load(const double* p) { return { _mm_loadu_pd(p), _mm_loadu_pd(p + 2) }; }
+    static Double4 pairs(double a, double b) { return { _mm_set1_pd(a), _mm_set1_pd(b) }; }
+    static Double4 zero() { return { _mm_setzero_pd(), _mm_setzero_pd() }; }
+
+    Double4 operator+(Double4 other) const { return { _mm_add_pd(lo, other.lo), _mm_add_pd(hi, other.hi) }; }
+    Double4 operator*(Double4 other) const { return { _mm_mul_pd(lo, other.lo), _mm_mul_pd(hi, other.hi) }; }
+
+    void sumFrames(double& left, double& right) const {
+        __m128d folded = _mm_add_pd(lo, hi);
+        left = _mm_cvtsd_f64(folded);
+        right = _mm_cvtsd_f64(_mm_unpackhi_pd(folded, folded));
+    }
+#elif HD_DOUBLE4_NEON
+    float64x2_t lo, hi;
+
+    static Double4 load(const double* p) { return { vld1q_f64(p), vld1q_f64(p + 2) }; }
+    static Double4 pairs(double a, double b) { return { vdupq_n_f64(a), vdupq_n_f64(b) }; }
+    static Double4 zero() { return { vdupq_n_f64(0.0), vdupq_n_f64(0.0) }; }
+
+    Double4 operator+(Double4 other) const { return { vaddq_f64(lo, other.lo), vaddq_f64(hi, other.hi) }; }
+    Double4 operator*(Double4 other) const { return { vmulq_f64(lo, other.lo), vmulq_f64(hi, other.hi) }; }
+
+    void sumFrames(double& left, double& right) const {
+        float64x2_t folded = vaddq_f64(lo, hi);
+        left = vgetq_lane_f64(folded, 0);
+        right = vgetq_lane_f64(folded, 1);
+    }
+#else
+    double v[4];
+
+    static Double4 load(const double* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    static Double4 pairs(double a, double b) { return { { a, a, b, b } }; }
+    static Double4 zero() { return { { 0.0, 0.0, 0.0, 0.0 } }; }
+
+    Double4 operator+(Double4 other) const { return { { v[0] + other.v[0], v[1] + other.v[1], v[2] + other.v[2], v[3] + other.v[3] } }; }
+    Double4 operator*(Double4 other) const { return { { v[0] * other.v[0], v[1] * other.v[1], v[2] * other.v[2], v[3] * other.v[3] } }; }
+
+    void sumFrames(double& left, double& right) const {
+        left = v[0] + v[2];
+        right = v[1] + v[3];
+    }
+#endif
+};
+
+// picks the four lane type for a sample type
+template <typename SampleType>
+struct Vector4;
+
+template <>
+struct Vector4<float> {
+    using Type = Float4;
+};
+
+template <>
+struct Vector4<double> {
+    using Type = Double4;
+};
@@ -0,0 +1,192 @@
+#include "GrowableDelayLine.h"
+
+template <typename SampleType>
+GrowableDelayLine<SampleType>::GrowableDelayLine()
+    : juce::Thread("Delay line growth"), active(std::make_unique<Line>()) {
+}
+
+template <typename SampleType>
+GrowableDelayLine<SampleType>::~GrowableDelayLine() {
+    stop();
+    freeInFlight();
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::prepare(int newNumChannels, int minNumSamples) {
+    stop();
+    freeInFlight();
+
+    active->setSize(newNumChannels, minNumSamples);
+    active->clear();
+
+    numChannels = newNumChannels;
+    clearedRequested = false;
+    requestedSamples = active->getNumSamples();
+    largestBuilt = active->getNumSamples();
+
+    startThread(juce::Thread::Priority::low);
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::release() {
+    stop();
+    freeInFlight();
+    active->setSize(0, 0);
+}
+
+template <typename SampleType>
+PairedDelayLine<SampleType>& GrowableDelayLine<SampleType>::getLine(int& writePosition, int numFrames) {
+    if (incoming == nullptr) {
+        if (auto* next = pending.exchange(nullptr, std::memory_order_acq_rel)) {
+            jassert(next->getNumSamples() > active->getNumSamples());
+            incoming.reset(next);
+            migrationStart = writePosition;
+            lastWritePosition = writePosition;
+            framesWritten = 0;
+            framesMigrated = 0;
+            // it may want to build the next one up already
+            wake();
+        }
+    }
+
+    if (incoming != nullptr)
+        migrate(writePosition, numFrames);
+
+    return *active;
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::migrate(int& writePosition, int numFrames) {
+    int length = active->getNumSamples();
+    jassert(numFrames <= length / 2);
+
+    // what the blocks since the last call wrote goes across at the same distance from migrationStart
+    int written = active->wrap(writePosition - lastWritePosition);
+    incoming->copyFramesFrom(*active, migrationStart + framesWritten, migrationStart + framesWritten, written);
+    framesWritten += written;
+    lastWritePosition = writePosition;
+
+    // the oldest history sits where the next writes go, so it moves over before they land on it. at twice the
+    // pace of the writes it's all across long before they could come round to it in the longer line
+    int wanted = juce::jmax(framesWritten + numFrames - framesMigrated, numFrames * 2, MIN_MIGRATION_FRAMES);
+    int chunk = juce::jmin(length - framesMigrated, wanted);
+    incoming->copyFramesFrom(*active, migrationStart + framesMigrated, migrationStart - length + framesMigrated, chunk);
+    framesMigrated += chunk;
+
+    // only swap once the last line we retired has been freed, so there's always a slot for this one
+    if (framesMigrated < length || retired.load(std::memory_order_acquire) != nullptr)
+        return;
+
+    writePosition = incoming->wrap(migrationStart + framesWritten);
+    retired.store(active.release(), std::memory_order_release);
+    active = std::move(incoming);
+    ++numGrows;
+    wake();
+}
+
+template <typename SampleType>
+bool GrowableDelayLine<SampleType>::ensureSize(int minNumSamples) {
+    if (active->getNumSamples() >= minNumSamples)
+        return true;
+
+    int current = requestedSamples.load(std::memory_order_relaxed);
+    while (current < minNumSamples) {
+        if (requestedSamples.compare_exchange_weak(current, minNumSamples, std::memory_order_relaxed)) {
+            wake();
+            break;
+        }
+    }
+
+    return false;
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::requestCleared() {
+    if (!clearedRequested.exchange(true, std::memory_order_relaxed))
+        wake();
+}
+
+template <typename SampleType>
+bool GrowableDelayLine<SampleType>::takeCleared() {
+    clearedRequested.store(false, std::memory_order_relaxed);
+
+    if (incoming != nullptr || retired.load(std::memory_order_acquire) != nullptr)
+        return false;
+
+    auto* next = cleared.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return false;
+
+    // built before the line last grew (or shrank back), so writePosition may not fit in it. the background
+    // thread frees it like any other retired line
+    if (next->getNumSamples() != active->getNumSamples()) {
+        retired.store(next, std::memory_order_release);
+        wake();
+        return false;
+    }
+
+    retired.store(active.release(), std::memory_order_release);
+    active.reset(next);
+    wake();
+    return true;
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::wake() {
+    // a futex or its equivalent, so the audio thread never takes a lock here
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_one();
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::stop() {
+    signalThreadShouldExit();
+    wake();
+    stopThread(1000);
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::run() {
+    while (!threadShouldExit()) {
+        // anything asked for after this load changes it, so the wait below can't sleep through a request
+        auto seen = wakeups.load(std::memory_order_acquire);
+
+        delete retired.exchange(nullptr, std::memory_order_acq_rel);
+
+        int wanted = requestedSamples.load(std::memory_order_relaxed);
+        if (wanted > largestBuilt && pending.load(std::memory_order_acquire) == nullptr) {
+            // rounded up to a power of two, so at least twice what it replaces
+            auto line = std::make_unique<Line>();
+            line->setSize(numChannels.load(), wanted);
+            largestBuilt = line->getNumSamples();
+            pending.store(line.release(), std::memory_order_release);
+        }
+
+        // a cleared line nobody wants any more, or one from before the line grew, would only get swapped in at
+        // the wrong length later
+        bool wantCleared = clearedRequested.load(std::memory_order_relaxed);
+        if (auto* stale = cleared.load(std::memory_order_acquire); stale != nullptr && (!wantCleared || stale->getNumSamples() != largestBuilt))
+            delete cleared.exchange(nullptr, std::memory_order_acq_rel);
+
+        // built at the largest length so far, so it's never shorter than the line it replaces
+        if (wantCleared && cleared.load(std::memory_order_acquire) == nullptr) {
+            auto line = std::make_unique<Line>();
+            line->setSize(numChannels.load(), largestBuilt);
+            cleared.store(line.release(), std::memory_order_release);
+        }
+
+        if (!threadShouldExit())
+            wakeups.wait(seen, std::memory_order_acquire);
+    }
+}
+
+template <typename SampleType>
+void GrowableDelayLine<SampleType>::freeInFlight() {
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+    delete cleared.exchange(nullptr);
+    incoming.reset();
+}
+
+template class GrowableDelayLine<float>;
+template class GrowableDelayLine<double>;
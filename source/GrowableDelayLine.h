@@ -0,0 +1,77 @@
+#pragma once
+
+#include "PairedDelayLine.h"
+#include <atomic>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+#include <memory>
+
+// owns the audio thread's PairedDelayLine and keeps it long enough without allocating on the audio thread.
+// prepare() sizes it for the worst case we can predict. if something still needs more (a pitch bend below
+// note 0, no note at all), the audio thread asks for it and a background thread builds the longer line.
+// lines change hands through atomic pointers: the new one in via pending (or cleared), the old one back out via retired.
+// the background thread only ever allocates and frees, it never touches a line the audio thread is using.
+// built for float and double in the .cpp
+template <typename SampleType>
+class GrowableDelayLine : private juce::Thread {
+public:
+    GrowableDelayLine();
+    ~GrowableDelayLine() override;
+
+    // not audio thread - allocates, drops any history and anything in flight
+    void prepare(int numChannels, int minNumSamples);
+    void release();
+
+    // audio thread - the line to write numFrames at writePosition into next. a longer line from the background
+    // thread gets the history moved into it a chunk per call, oldest first and ahead of the writes, while the
+    // old one stays in use. once it has all of it, it takes over and writePosition moves to match
+    PairedDelayLine<SampleType>& getLine(int& writePosition, int numFrames);
+
+    // audio thread - asks for at least this many samples, returns true if we already have them
+    bool ensureSize(int minNumSamples);
+
+    // audio thread - the line is about to sit idle, so have the background thread get a cleared one ready
+    void requestCleared();
+    // audio thread - swaps the cleared line in, dropping the history. if it isn't ready yet, or a longer line
+    // is still being filled, the old history stays, which only happens when the line wasn't idle for long
+    bool takeCleared();
+
+    // audio thread - how many times getLine() has swapped in a longer line
+    int getNumGrows() const { return numGrows; }
+
+private:
+    using Line = PairedDelayLine<SampleType>;
+
+    // each getLine() moves at least this much history across, however short the block
+    static constexpr int MIN_MIGRATION_FRAMES = 4096;
+
+    std::unique_ptr<Line> active;
+    int numGrows = 0;
+    std::atomic<Line*> pending { nullptr };
+    std::atomic<Line*> retired { nullptr };
+    std::atomic<Line*> cleared { nullptr };
+    std::atomic<bool> clearedRequested { false };
+
+    // audio thread owned - the longer line being filled. frames keep the same distance from migrationStart, the
+    // write position when it arrived, so the history lands below it and new writes carry on above it
+    std::unique_ptr<Line> incoming;
+    int migrationStart = 0;
+    int framesWritten = 0;
+    int framesMigrated = 0;
+    int lastWritePosition = 0;
+
+    std::atomic<int> requestedSamples { 0 };
+    std::atomic<int> numChannels { 0 };
+    // bumped whenever there's something for the background thread to do, it sleeps on this in between
+    std::atomic<uint32_t> wakeups { 0 };
+    // only touched by the background thread once it's running
+    int largestBuilt = 0;
+
+    void run() override;
+    void wake();
+    void stop();
+    void migrate(int& writePosition, int numFrames);
+    void freeInFlight();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GrowableDelayLine)
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// fractional delay interpolators for PairedDelayLine.
+// each one reads numTaps consecutive samples starting (numTaps / 2 - 1) before the integer read position
+// and fills numTaps weights for the fraction, in the delay line's sample type.
+// numTaps has to be even since the kernel loads two frames at a time
+enum class Interpolation {
+    linear = 0,
+    hermite,
+    lagrange,
+    sinc
+};
+
+struct LinearInterpolator {
+    static constexpr int numTaps = 2;
+
+    template <typename T>
+    static void getWeights(T frac, T* weights) {
+        weights[0] = T(1) - frac;
+        weights[1] = frac;
+    }
+};
+
+// 4 point, 3rd order hermite (catmull-rom)
+struct HermiteInterpolator {
+    static constexpr int numTaps = 4;
+
+    template <typename T>
+    static void getWeights(T frac, T* weights) {
+        T frac2 = frac * frac;
+        T frac3 = frac2 * frac;
+        weights[0] = T(-0.5) * frac3 + frac2 - T(0.5) * frac;
+        weights[1] = T(1.5) * frac3 - T(2.5) * frac2 + T(1);
+        weights[2] = T(-1.5) * frac3 + T(2) * frac2 + T(0.5) * frac;
+        weights[3] = T(0.5) * frac3 - T(0.5) * frac2;
+    }
+};
+
+// 6 point, 5th order lagrange
+struct LagrangeInterpolator {
+    static constexpr int numTaps = 6;
+
+    template <typename T>
+    static void getWeights(T frac, T* weights) {
+        // taps sit at -2 ... 3 relative to the integer read position
+        T d[numTaps];
+        for (int i = 0; i < numTaps; ++i)
+            d[i] = frac - static_cast<T>(i - 2);
+
+        // denominators are prod (i - j) for j != i, fixed for these tap positions
+        constexpr T denominators[numTaps] = { -120, 24, -12, 12, -24, 120 };
+
+        for (int i = 0; i < numTaps; ++i) {
+            T numerator = 1;
+            for (int j = 0; j < numTaps; ++j) {
+                if (j != i)
+                    numerator *= d[j];
+            }
+            weights[i] = numerator / denominators[i];
+        }
+    }
+};
+
+// 8 tap windowed sinc, read from a polyphase table and interpolated between neighbouring phases
+struct SincInterpolator {
+    static constexpr int numTaps = 8;
+    static constexpr int numPhases = 256;
+
+    template <typename T>
+    struct Table {
+        // numPhases + 1 rows so the last phase has a neighbour to interpolate towards
+        std::array<std::array<T, numTaps>, numPhases + 1> rows {};
+
+        Table() {
+            constexpr double pi = 3.14159265358979323846;
+            constexpr double halfWidth = numTaps / 2;
+
+            for (int phase = 0; phase <= numPhases; ++phase) {
+                double frac = phase / static_cast<double>(numPhases);
+                double sum = 0.0;
+                std::array<double, numTaps> taps {};
+
+                for (int i = 0; i < numTaps; ++i) {
+                    double t = static_cast<double>(i - (numTaps / 2 - 1)) - frac;
+                    double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+                    // blackman-harris over [-halfWidth, halfWidth]
+                    double w = (t + halfWidth) / (2.0 * halfWidth);
+                    double window = 0.35875 - 0.48829 * std::cos(2.0 * pi * w) + 0.14128 * std::cos(4.0 * pi * w) - 0.01168 * std::cos(6.0 * pi * w);
+                    taps[i] = sinc * window;
+                    sum += taps[i];
+                }
+
+                // unity gain at dc for every phase
+                for (int i = 0; i < numTaps; ++i)
+                    rows[phase][i] = static_cast<T>(taps[i] / sum);
+            }
+        }
+    };
+
+    template <typename T>
+    static const Table<T>& getTable() {
+        static const Table<T> table;
+        return table;
+    }
+
+    template <typename T>
+    static void getWeights(T frac, T* weights) {
+        const auto& table = getTable<T>();
+        T position = frac * numPhases;
+        int phase = std::min(static_cast<int>(position), numPhases - 1);
+        T blend = position - static_cast<T>(phase);
+        const auto& a = table.rows[phase];
+        const auto& b = table.rows[phase + 1];
+
+        for (int i = 0; i < numTaps; ++i)
+            weights[i] = a[i] + (b[i] - a[i]) * blend;
+    }
+};
+
+// the widest interpolator, for sizing guard regions
+inline constexpr int MAX_INTERPOLATION_TAPS = SincInterpolator::numTaps;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+// a plain whole-sample delay at the host rate, used to line the bypass path up with the oversamplers' latency.
+// each block's input is pushed before the buffer gets overwritten and read back afterwards, so the line holds
+// a full block on top of the longest delay
+template <typename SampleType>
+class LatencyDelay {
+public:
+    // allocates
+    void prepare(int numChannels, int maxBlockSize, int maxDelaySamples) {
+        int size = juce::nextPowerOfTwo(maxBlockSize + maxDelaySamples + 1);
+        lines.assign(static_cast<size_t>(numChannels), std::vector<SampleType>(static_cast<size_t>(size), SampleType(0)));
+        mask = size - 1;
+        writePosition = 0;
+        blockStart = 0;
+        numPushed = 0;
+    }
+
+    void setDelay(int numSamples) { delay = numSamples; }
+
+    // audio thread - remembers this block's input
+    void push(const juce::AudioBuffer<SampleType>& input) {
+        numPushed = input.getNumSamples();
+        blockStart = writePosition;
+
+        for (size_t channel = 0; channel < lines.size() && static_cast<int>(channel) < input.getNumChannels(); ++channel) {
+            const auto* source = input.getReadPointer(static_cast<int>(channel));
+            auto& line = lines[channel];
+            for (int i = 0; i < numPushed; ++i)
+                line[static_cast<size_t>((writePosition + i) & mask)] = source[i];
+        }
+
+        writePosition = (writePosition + numPushed) & mask;
+    }
+
+    // audio thread - blends the delayed input of the last pushed block into output, the delayed side's gain going
+    // from startGain to endGain across the block. 1 to 1 replaces output outright
+    void mixInto(juce::AudioBuffer<SampleType>& output, SampleType startGain, SampleType endGain) const {
+        int numSamples = juce::jmin(numPushed, output.getNumSamples());
+        SampleType gainStep = numSamples > 0 ? (endGain - startGain) / static_cast<SampleType>(numSamples) : SampleType(0);
+
+        for (size_t channel = 0; channel < lines.size() && static_cast<int>(channel) < output.getNumChannels(); ++channel) {
+            auto* dest = output.getWritePointer(static_cast<int>(channel));
+            const auto& line = lines[channel];
+            int readStart = blockStart - delay;
+
+            if (startGain == SampleType(1) && endGain == SampleType(1)) {
+                for (int i = 0; i < numSamples; ++i)
+                    dest[i] = line[static_cast<size_t>((readStart + i) & mask)];
+            } else {
+                for (int i = 0; i < numSamples; ++i) {
+                    SampleType gain = startGain + gainStep * static_cast<SampleType>(i);
+                    SampleType delayed = line[static_cast<size_t>((readStart + i) & mask)];
+                    dest[i] += gain * (delayed - dest[i]);
+                }
+            }
+        }
+    }
+
+    int getNumChannels() const { return static_cast<int>(lines.size()); }
+
+    // audio thread - sample of the last pushed block's input as mixInto() would have it, delayed
+    SampleType getDelayedSample(int channel, int sample) const {
+        return lines[static_cast<size_t>(channel)][static_cast<size_t>((blockStart - delay + sample) & mask)];
+    }
+
+private:
+    std::vector<std::vector<SampleType>> lines;
+    int mask = 0;
+    int writePosition = 0;
+    int blockStart = 0;
+    int numPushed = 0;
+    int delay = 0;
+};
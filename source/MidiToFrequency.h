@@ -10,12 +10,21 @@ public:
 
     void processMidiBuffer(const juce::MidiBuffer& midiMessages);
 
+    // one event at a time, for splitting a block at event boundaries. returns true for a note on
+    bool processMidiMessage(const juce::MidiMessage& msg);
+
     std::optional<double> getCurrentFrequency() const;
 
     bool wasNoteOn() const { return noteOnOccurred; }
 
     void setPitchBendRange(double range) { pitchBendRange = range; }
 
+    // drops the bend and the note on flag, the last note stays since it's restored with the rest of the state
+    void reset() {
+        currentPitchBend = 0.0;
+        noteOnOccurred = false;
+    }
+
     double getLastFrequency() const {
         if (lastMidiNote < 0)
             return -1.0;
@@ -44,19 +53,26 @@ inline void MidiToFrequency::processMidiBuffer(const juce::MidiBuffer& midiMessa
     noteOnOccurred = false;
 
     for (auto event : midiMessages) {
-        auto msg = event.getMessage();
-
-        if (msg.isNoteOn()) {
-            lastMidiNote = msg.getNoteNumber();
-            currentPitchBend = 0.0;
+        if (processMidiMessage(event.getMessage()))
             noteOnOccurred = true;
-        } else if (msg.isPitchWheel()) {
-            int pitchWheelValue = msg.getPitchWheelValue();
-            currentPitchBend = ((pitchWheelValue - 8192) / 8192.0) * pitchBendRange;
-        }
     }
 }
 
+inline bool MidiToFrequency::processMidiMessage(const juce::MidiMessage& msg) {
+    if (msg.isNoteOn()) {
+        lastMidiNote = msg.getNoteNumber();
+        currentPitchBend = 0.0;
+        return true;
+    }
+
+    if (msg.isPitchWheel()) {
+        int pitchWheelValue = msg.getPitchWheelValue();
+        currentPitchBend = ((pitchWheelValue - 8192) / 8192.0) * pitchBendRange;
+    }
+
+    return false;
+}
+
 inline std::optional<double> MidiToFrequency::getCurrentFrequency() const {
     if (lastMidiNote < 0) {
         return std::nullopt;
@@ -0,0 +1,44 @@
+#include "OversamplerBank.h"
+
+template <typename SampleType>
+void OversamplerBank<SampleType>::prepare(int numChannels, int maxBlockSize) {
+    numChannels = juce::jmax(1, numChannels);
+
+    for (int setting = 0; setting < NUM_SETTINGS; ++setting) {
+        auto& oversampler = oversamplers[static_cast<size_t>(setting)];
+
+        // the filters are fixed per channel count, so they only get rebuilt if that changes
+        if (oversampler == nullptr || numChannels != preparedChannels) {
+            using Oversampler = juce::dsp::Oversampling<SampleType>;
+            auto filter = static_cast<Filter>(setting % NUM_FILTERS) == Filter::iir
+                              ? Oversampler::filterHalfBandPolyphaseIIR
+                              : Oversampler::filterHalfBandFIREquiripple;
+            // the number of stages is log2 of the factor, 0 stages passes straight through
+            auto numStages = static_cast<size_t>(setting / NUM_FILTERS);
+            // integer latency, so the bypass delay and what we report to the host line up with the wet signal
+            // exactly and the crossfade between them doesn't comb filter
+            oversampler = std::make_unique<Oversampler>(static_cast<size_t>(numChannels), numStages, filter, true, true);
+        }
+
+        oversampler->initProcessing(static_cast<size_t>(maxBlockSize));
+        oversampler->reset();
+    }
+
+    preparedChannels = numChannels;
+}
+
+template <typename SampleType>
+void OversamplerBank<SampleType>::release() {
+    for (auto& oversampler : oversamplers)
+        oversampler.reset();
+    preparedChannels = 0;
+}
+
+template <typename SampleType>
+int OversamplerBank<SampleType>::getLatencySamples(int setting) const {
+    auto& oversampler = oversamplers[static_cast<size_t>(setting)];
+    return oversampler != nullptr ? static_cast<int>(oversampler->getLatencyInSamples()) : 0;
+}
+
+template class OversamplerBank<float>;
+template class OversamplerBank<double>;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+
+// the factor/filter combinations the quality parameters can pick, numbered so a setting is one int
+struct OversamplingSettings {
+    enum class Filter { iir = 0, linearPhase };
+
+    // 1x, 2x, 4x, 8x
+    static constexpr int NUM_FACTORS = 4;
+    static constexpr int NUM_FILTERS = 2;
+    static constexpr int NUM_SETTINGS = NUM_FACTORS * NUM_FILTERS;
+    static constexpr int MAX_FACTOR = 1 << (NUM_FACTORS - 1);
+
+    static int getSetting(int factorIndex, Filter filter) {
+        return juce::jlimit(0, NUM_FACTORS - 1, factorIndex) * NUM_FILTERS + static_cast<int>(filter);
+    }
+
+    static int getFactor(int setting) { return 1 << (setting / NUM_FILTERS); }
+};
+
+// one juce oversampler for every setting. they're all built and sized in prepare(), so switching between them
+// on the audio thread is just picking another index. built for float and double in the .cpp
+template <typename SampleType>
+class OversamplerBank : public OversamplingSettings {
+public:
+    // allocates
+    void prepare(int numChannels, int maxBlockSize);
+    void release();
+
+    // audio thread
+    juce::dsp::Oversampling<SampleType>& get(int setting) { return *oversamplers[static_cast<size_t>(setting)]; }
+
+    int getLatencySamples(int setting) const;
+
+private:
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, NUM_SETTINGS> oversamplers;
+    int preparedChannels = 0;
+};
@@ -0,0 +1,107 @@
+#include "PairWorkerPool.h"
+#include <thread>
+
+class PairWorkerPool::Worker : public juce::Thread {
+public:
+    Worker(PairWorkerPool& owner, int index)
+        : juce::Thread("Pair worker " + juce::String(index)), pool(owner) {
+    }
+
+    ~Worker() override {
+        stopThread(1000);
+    }
+
+    void run() override {
+        auto seen = pool.wakeups.load(std::memory_order_acquire);
+        juce::int64 spinUntil = 0;
+
+        while (!threadShouldExit()) {
+            auto wakeup = pool.wakeups.load(std::memory_order_acquire);
+            if (wakeup != seen) {
+                seen = wakeup;
+                auto startTicks = juce::Time::getHighResolutionTicks();
+                pool.help(getGeneration(pool.claims.load(std::memory_order_acquire)));
+
+                // a block split at midi events starts its jobs back to back, so look for the next one for about
+                // as long as this one took. the gap to the next host block is far longer, that one wakes us
+                auto now = juce::Time::getHighResolutionTicks();
+                spinUntil = now + juce::jmin(now - startTicks, maxSpinTicks);
+                continue;
+            }
+
+            if (juce::Time::getHighResolutionTicks() < spinUntil)
+                std::this_thread::yield();
+            else
+                pool.wakeups.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+private:
+    // however long a job took, never spin for more than this
+    static constexpr double MAX_SPIN_SECONDS = 0.0005;
+    const juce::int64 maxSpinTicks = static_cast<juce::int64>(MAX_SPIN_SECONDS * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()));
+
+    PairWorkerPool& pool;
+};
+
+PairWorkerPool::PairWorkerPool() = default;
+
+PairWorkerPool::~PairWorkerPool() {
+    release();
+}
+
+void PairWorkerPool::prepare(int numPairs) {
+    int maxWorkers = juce::jmin(MAX_WORKERS, juce::SystemStats::getNumCpus() - 1);
+    int wanted = juce::jlimit(0, juce::jmax(0, maxWorkers), numPairs / MIN_PAIRS_PER_THREAD - 1);
+
+    if (wanted == getNumWorkers())
+        return;
+
+    release();
+    for (int index = 0; index < wanted; ++index) {
+        workers.push_back(std::make_unique<Worker>(*this, index));
+        workers.back()->startThread(juce::Thread::Priority::highest);
+    }
+}
+
+void PairWorkerPool::release() {
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+    // parked workers only wake for this, not for juce's own signal
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_all();
+    workers.clear();
+}
+
+uint32_t PairWorkerPool::start(int numPairs, void (*function)(void*, int), void* context) {
+    jobFunction.store(function, std::memory_order_relaxed);
+    jobContext.store(context, std::memory_order_relaxed);
+    numJobPairs.store(numPairs, std::memory_order_relaxed);
+    completed.store(0, std::memory_order_relaxed);
+
+    // publishing the new generation with pair 0 unclaimed is what makes the job visible
+    auto generation = getGeneration(claims.load(std::memory_order_relaxed)) + 1;
+    claims.store(static_cast<uint64_t>(generation) << 32, std::memory_order_release);
+
+    // a futex or its equivalent, which only costs a system call when a worker is actually parked
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_all();
+    return generation;
+}
+
+void PairWorkerPool::help(uint32_t generation) {
+    auto current = claims.load(std::memory_order_acquire);
+
+    while (getGeneration(current) == generation) {
+        auto pair = static_cast<int>(current & 0xffffffffu);
+        if (pair >= numJobPairs.load(std::memory_order_relaxed))
+            return;
+
+        // the claim only goes through if this is still the same job
+        if (claims.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            jobFunction.load(std::memory_order_relaxed)(jobContext.load(std::memory_order_relaxed), pair);
+            completed.fetch_add(1, std::memory_order_release);
+            current = claims.load(std::memory_order_acquire);
+        }
+    }
+}
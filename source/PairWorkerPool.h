@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+// helpers for the audio thread when a bus has enough channel pairs to be worth splitting up. the audio thread
+// takes part in every job and only waits for pairs a worker has already started, so a worker that's slow to
+// wake costs its help and nothing else. workers park on an atomic between blocks and starting a job bumps it,
+// so the audio thread never takes a lock, and only makes the wake call when someone is parked
+class PairWorkerPool {
+public:
+    // each thread, the audio thread included, should get at least this many pairs
+    static constexpr int MIN_PAIRS_PER_THREAD = 2;
+    static constexpr int MAX_WORKERS = 3;
+
+    PairWorkerPool();
+    ~PairWorkerPool();
+
+    // not audio thread - starts as many workers as numPairs is worth, which may be none
+    void prepare(int numPairs);
+    void release();
+
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+    // audio thread - calls job(pair) for every pair in [0, numPairs) and returns once they've all finished
+    template <typename Job>
+    void run(int numPairs, Job& job);
+
+private:
+    class Worker;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // generation in the top 32 bits, next unclaimed pair in the bottom 32, so a late claim can't land in a later job
+    std::atomic<uint64_t> claims { 0 };
+    std::atomic<int> numJobPairs { 0 };
+    std::atomic<int> completed { 0 };
+    std::atomic<void (*)(void*, int)> jobFunction { nullptr };
+    std::atomic<void*> jobContext { nullptr };
+    // bumped after every start() and on release(), what parked workers wait on
+    std::atomic<uint32_t> wakeups { 0 };
+
+    uint32_t start(int numPairs, void (*function)(void*, int), void* context);
+    // claims and runs pairs from this generation's job until there are none left
+    void help(uint32_t generation);
+
+    static uint32_t getGeneration(uint64_t value) { return static_cast<uint32_t>(value >> 32); }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PairWorkerPool)
+};
+
+template <typename Job>
+void PairWorkerPool::run(int numPairs, Job& job) {
+    if (workers.empty() || numPairs < MIN_PAIRS_PER_THREAD * 2) {
+        for (int pair = 0; pair < numPairs; ++pair)
+            job(pair);
+        return;
+    }
+
+    auto generation = start(numPairs, [](void* context, int pair) { (*static_cast<Job*>(context))(pair); }, &job);
+    help(generation);
+
+    // everything's claimed by now, so this only waits on pairs that are already being worked on, never longer
+    // than one pair takes
+    while (completed.load(std::memory_order_acquire) < numPairs) {
+    }
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Float4.h"
+#include "Interpolators.h"
+#include <algorithm>
+#include <cmath>
+#include <juce_core/juce_core.h>
+#include <vector>
+
+// the displacement delay line. channels are stored as interleaved pairs, so frame i of a pair is
+// { left[i], right[i] } and one unaligned load fetches both sides of two neighbouring frames.
+// phase, lfo and read position are the same for every channel, so the index math runs once per pair.
+// a mono (or odd trailing) channel is paired with itself.
+// the length is always a power of two so wrapping is a mask rather than a modulo.
+// SampleType is float or double, the whole kernel runs at that precision
+template <typename SampleType>
+class PairedDelayLine {
+public:
+    // frames past the end that mirror the start, so an interpolator's taps never straddle the wrap
+    static constexpr int GUARD_FRAMES = MAX_INTERPOLATION_TAPS - 1;
+
+    PairedDelayLine() = default;
+
+    // allocates - the length is rounded up to the next power of two
+    void setSize(int newNumChannels, int minNumSamples, bool keepExistingContent = false);
+    void clear();
+
+    int getNumChannels() const { return numChannels; }
+    int getNumPairs() const { return (numChannels + 1) / 2; }
+    int getNumSamples() const { return numSamples; }
+
+    int wrap(int position) const { return position & mask; }
+
+    // copies numFrames frames of other, starting at from and wrapping there, in here starting at to and wrapping
+    // here. no allocation
+    void copyFramesFrom(const PairedDelayLine& other, int from, int to, int numFrames);
+
+    // samples of history an interpolator needs on top of the longest delay
+    static constexpr int getRequiredHeadroom() { return MAX_INTERPOLATION_TAPS + 1; }
+
+    // writes a block of one pair into the line and replaces it with the displaced signal.
+    // left and right can be the same pointer for a lone channel
+    void processPair(Interpolation interpolation, int pair, int writePosition, SampleType* left, SampleType* right, const double* readOffsets, const float* dryWet, int numBlockSamples);
+
+    template <typename Interpolator>
+    void processPair(int pair, int writePosition, SampleType* left, SampleType* right, const double* readOffsets, const float* dryWet, int numBlockSamples);
+
+private:
+    using Vector = typename Vector4<SampleType>::Type;
+
+    std::vector<SampleType> data;
+    int numChannels = 0;
+    int numSamples = 0;
+    int mask = 0;
+    // values per pair, including the guard frames
+    size_t pairStride = 0;
+
+    SampleType* getPairPointer(int pair) { return data.data() + static_cast<size_t>(pair) * pairStride; }
+    const SampleType* getPairPointer(int pair) const { return data.data() + static_cast<size_t>(pair) * pairStride; }
+
+    void refreshGuardFrames();
+};
+
+template <typename SampleType>
+void PairedDelayLine<SampleType>::setSize(int newNumChannels, int minNumSamples, bool keepExistingContent) {
+    int newNumSamples = minNumSamples > 0 ? juce::nextPowerOfTwo(minNumSamples) : 0;
+    size_t newStride = static_cast<size_t>(newNumSamples + GUARD_FRAMES) * 2;
+    std::vector<SampleType> newData(static_cast<size_t>((newNumChannels + 1) / 2) * newStride, SampleType(0));
+
+    if (keepExistingContent) {
+        int pairsToCopy = std::min((newNumChannels + 1) / 2, getNumPairs());
+        size_t valuesToCopy = static_cast<size_t>(std::min(numSamples, newNumSamples)) * 2;
+        for (int pair = 0; pair < pairsToCopy; ++pair)
+            std::copy_n(getPairPointer(pair), valuesToCopy, newData.data() + static_cast<size_t>(pair) * newStride);
+    }
+
+    data = std::move(newData);
+    numChannels = newNumChannels;
+    numSamples = newNumSamples;
+    mask = std::max(0, newNumSamples - 1);
+    pairStride = newStride;
+
+    refreshGuardFrames();
+}
+
+template <typename SampleType>
+void PairedDelayLine<SampleType>::refreshGuardFrames() {
+    if (numSamples == 0)
+        return;
+
+    for (int pair = 0; pair < getNumPairs(); ++pair) {
+        auto* ring = getPairPointer(pair);
+        for (int frame = 0; frame < GUARD_FRAMES; ++frame) {
+            ring[2 * (numSamples + frame)] = ring[2 * (frame & mask)];
+            ring[2 * (numSamples + frame) + 1] = ring[2 * (frame & mask) + 1];
+        }
+    }
+}
+
+template <typename SampleType>
+void PairedDelayLine<SampleType>::copyFramesFrom(const PairedDelayLine& other, int from, int to, int numFrames) {
+    if (numFrames <= 0 || numSamples == 0 || other.numSamples == 0)
+        return;
+
+    int pairsToCopy = std::min(getNumPairs(), other.getNumPairs());
+
+    for (int pair = 0; pair < pairsToCopy; ++pair) {
+        const auto* source = other.getPairPointer(pair);
+        auto* dest = getPairPointer(pair);
+
+        // in runs that wrap in neither line
+        for (int done = 0; done < numFrames;) {
+            int sourceFrame = other.wrap(from + done);
+            int destFrame = wrap(to + done);
+            int run = std::min({ numFrames - done, other.numSamples - sourceFrame, numSamples - destFrame });
+            std::copy_n(source + static_cast<size_t>(sourceFrame) * 2, static_cast<size_t>(run) * 2, dest + static_cast<size_t>(destFrame) * 2);
+            done += run;
+        }
+    }
+
+    refreshGuardFrames();
+}
+
+template <typename SampleType>
+void PairedDelayLine<SampleType>::clear() {
+    std::fill(data.begin(), data.end(), SampleType(0));
+}
+
+template <typename SampleType>
+void PairedDelayLine<SampleType>::processPair(Interpolation interpolation, int pair, int writePosition, SampleType* left, SampleType* right, const double* readOffsets, const float* dryWet, int numBlockSamples) {
+    // one branch per block, the per-sample loop is specialised for each interpolator
+    switch (interpolation) {
+        case Interpolation::hermite:
+            processPair<HermiteInterpolator>(pair, writePosition, left, right, readOffsets, dryWet, numBlockSamples);
+            break;
+        case Interpolation::lagrange:
+            processPair<LagrangeInterpolator>(pair, writePosition, left, right, readOffsets, dryWet, numBlockSamples);
+            break;
+        case Interpolation::sinc:
+            processPair<SincInterpolator>(pair, writePosition, left, right, readOffsets, dryWet, numBlockSamples);
+            break;
+        case Interpolation::linear:
+        default:
+            processPair<LinearInterpolator>(pair, writePosition, left, right, readOffsets, dryWet, numBlockSamples);
+            break;
+    }
+}
+
+template <typename SampleType>
+template <typename Interpolator>
+void PairedDelayLine<SampleType>::processPair(int pair, int writePosition, SampleType* left, SampleType* right, const double* readOffsets, const float* dryWet, int numBlockSamples) {
+    constexpr int numTaps = Interpolator::numTaps;
+    static_assert(numTaps % 2 == 0 && numTaps <= MAX_INTERPOLATION_TAPS);
+
+    // taps reach numTaps / 2 past the read position, so the widest interpolator has to read a little further
+    // back to keep every tap behind the write head. the others read from just as far back, so changing the
+    // interpolation mid note doesn't move the read head
+    constexpr int tapOffset = MAX_INTERPOLATION_TAPS / 2 - 1 + numTaps / 2 - 1;
+
+    auto* ring = getPairPointer(pair);
+    SampleType* guard = ring + 2 * numSamples;
+    int writePos = writePosition;
+    SampleType weights[numTaps];
+
+    for (int sample = 0; sample < numBlockSamples; ++sample) {
+        SampleType dryLeft = left[sample];
+        SampleType dryRight = right[sample];
+
+        ring[2 * writePos] = dryLeft;
+        ring[2 * writePos + 1] = dryRight;
+        if (writePos < GUARD_FRAMES) {
+            guard[2 * writePos] = dryLeft;
+            guard[2 * writePos + 1] = dryRight;
+        }
+
+        // read offsets are never longer than the line, so adding its length keeps the position positive
+        // and truncating is the same as flooring
+        double readPos = writePos + numSamples + readOffsets[sample];
+        auto readIdx = static_cast<int>(readPos);
+        auto frac = static_cast<SampleType>(readPos - readIdx);
+        int firstTap = (readIdx - tapOffset) & mask;
+
+        Interpolator::getWeights(frac, weights);
+
+        // all taps are contiguous thanks to the guard frames
+        const SampleType* taps = ring + 2 * firstTap;
+        auto sum = Vector::zero();
+        for (int tap = 0; tap < numTaps; tap += 2)
+            sum = sum + Vector::load(taps + 2 * tap) * Vector::pairs(weights[tap], weights[tap + 1]);
+
+        SampleType wetLeft, wetRight;
+        sum.sumFrames(wetLeft, wetRight);
+
+        auto dryWetValue = static_cast<SampleType>(dryWet[sample]);
+        left[sample] = dryLeft * (SampleType(1) - dryWetValue) + wetLeft * dryWetValue;
+        if (right != left)
+            right[sample] = dryRight * (SampleType(1) - dryWetValue) + wetRight * dryWetValue;
+
+        writePos = (writePos + 1) & mask;
+    }
+}
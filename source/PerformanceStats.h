@@ -0,0 +1,169 @@
+#pragma once
+
+// off unless the build asks for it, configuring with -DHD_PERF_STATS=ON has cmake pass -DHD_PERF_STATS=1
+#ifndef HD_PERF_STATS
+    #define HD_PERF_STATS 0
+#endif
+
+#if HD_PERF_STATS
+
+    #include <array>
+    #include <atomic>
+    #include <cmath>
+    #include <cstdint>
+    #include <juce_core/juce_core.h>
+
+// what processBlock costs, timed on the audio thread and read from anywhere. the audio thread is the only writer,
+// so every counter is a plain atomic it stores to, nothing waits and nothing is allocated after construction.
+// block times and ns per sample go into histograms with power of two buckets, and the worst block, the average
+// cost and the oversampling share are taken over windows of WINDOW_SECONDS of audio, published as each one ends.
+// a snapshot reads each counter on its own, so the numbers in it can be a block apart from each other
+class PerformanceStats {
+public:
+    // bucket b counts values in [2^b, 2^(b + 1)), the first and last also take everything below and above
+    static constexpr int NUM_BUCKETS = 24;
+    static constexpr double WINDOW_SECONDS = 1.0;
+
+    using Histogram = std::array<uint32_t, NUM_BUCKETS>;
+
+    struct Snapshot {
+        uint64_t numBlocks = 0;
+        uint64_t numSamples = 0;
+        // the whole block, host samples
+        double lastBlockMicros = 0.0;
+        double lastNanosPerSample = 0.0;
+        // over the last complete window
+        double worstBlockMicros = 0.0;
+        double windowNanosPerSample = 0.0;
+        // all the blocks in it, and the parts of that spent oversampling and in the delay line loop
+        double windowMicros = 0.0;
+        double oversamplingMicros = 0.0;
+        double coreMicros = 0.0;
+        // how many times the delay line was swapped for a longer one
+        uint32_t ringResizes = 0;
+        // microseconds per block
+        Histogram blockMicros {};
+        Histogram nanosPerSample {};
+    };
+
+    // audio thread - a timestamp for the calls below
+    static int64_t now() { return juce::Time::getHighResolutionTicks(); }
+
+    // not audio thread
+    void prepare(double sampleRate) {
+        windowLength = static_cast<uint64_t>(juce::jmax(1.0, sampleRate * WINDOW_SECONDS));
+        secondsPerTick = 1.0 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+        windowSamples = 0;
+        windowTicks = 0;
+        windowWorstTicks = 0;
+        windowOversamplingTicks = 0;
+        windowCoreTicks = 0;
+    }
+
+    // audio thread - time spent inside the oversamplers and inside the delay line loop, since the block started
+    void addOversampling(int64_t ticks) { blockOversamplingTicks += ticks; }
+    void addCore(int64_t ticks) { blockCoreTicks += ticks; }
+    void addRingResizes(int count) { store(ringResizes, ringResizes.load(std::memory_order_relaxed) + static_cast<uint32_t>(count)); }
+
+    // audio thread - closes the block that started at startTicks
+    void endBlock(int64_t startTicks, int numSamples);
+
+    // any thread
+    Snapshot getSnapshot() const;
+
+private:
+    std::atomic<uint64_t> numBlocks { 0 };
+    std::atomic<uint64_t> numSamplesTotal { 0 };
+    std::atomic<double> lastBlockMicros { 0.0 };
+    std::atomic<double> lastNanosPerSample { 0.0 };
+    std::atomic<double> worstBlockMicros { 0.0 };
+    std::atomic<double> windowNanosPerSample { 0.0 };
+    std::atomic<double> windowMicros { 0.0 };
+    std::atomic<double> oversamplingMicros { 0.0 };
+    std::atomic<double> coreMicros { 0.0 };
+    std::atomic<uint32_t> ringResizes { 0 };
+    std::array<std::atomic<uint32_t>, NUM_BUCKETS> blockHistogram {};
+    std::array<std::atomic<uint32_t>, NUM_BUCKETS> sampleHistogram {};
+
+    // audio thread owned
+    double secondsPerTick = 1.0e-9;
+    int64_t blockOversamplingTicks = 0;
+    int64_t blockCoreTicks = 0;
+    uint64_t windowLength = 44100;
+    uint64_t windowSamples = 0;
+    int64_t windowTicks = 0;
+    int64_t windowWorstTicks = 0;
+    int64_t windowOversamplingTicks = 0;
+    int64_t windowCoreTicks = 0;
+
+    // single writer, so there's no need for a read-modify-write
+    template <typename T>
+    static void store(std::atomic<T>& counter, T value) { counter.store(value, std::memory_order_relaxed); }
+
+    static void count(std::array<std::atomic<uint32_t>, NUM_BUCKETS>& histogram, double value) {
+        int bucket = value < 1.0 ? 0 : juce::jmin(NUM_BUCKETS - 1, static_cast<int>(std::log2(value)));
+        auto& counter = histogram[static_cast<size_t>(bucket)];
+        store(counter, counter.load(std::memory_order_relaxed) + 1);
+    }
+
+    double toMicros(int64_t ticks) const { return static_cast<double>(ticks) * secondsPerTick * 1.0e6; }
+};
+
+inline void PerformanceStats::endBlock(int64_t startTicks, int numSamples) {
+    int64_t ticks = now() - startTicks;
+    double micros = toMicros(ticks);
+    double nanosPerSample = numSamples > 0 ? micros * 1000.0 / numSamples : 0.0;
+
+    store(numBlocks, numBlocks.load(std::memory_order_relaxed) + 1);
+    store(numSamplesTotal, numSamplesTotal.load(std::memory_order_relaxed) + static_cast<uint64_t>(numSamples));
+    store(lastBlockMicros, micros);
+    store(lastNanosPerSample, nanosPerSample);
+    count(blockHistogram, micros);
+    count(sampleHistogram, nanosPerSample);
+
+    windowSamples += static_cast<uint64_t>(numSamples);
+    windowTicks += ticks;
+    windowWorstTicks = juce::jmax(windowWorstTicks, ticks);
+    windowOversamplingTicks += blockOversamplingTicks;
+    windowCoreTicks += blockCoreTicks;
+    blockOversamplingTicks = 0;
+    blockCoreTicks = 0;
+
+    if (windowSamples < windowLength)
+        return;
+
+    store(worstBlockMicros, toMicros(windowWorstTicks));
+    store(windowNanosPerSample, toMicros(windowTicks) * 1000.0 / static_cast<double>(windowSamples));
+    store(windowMicros, toMicros(windowTicks));
+    store(oversamplingMicros, toMicros(windowOversamplingTicks));
+    store(coreMicros, toMicros(windowCoreTicks));
+
+    windowSamples = 0;
+    windowTicks = 0;
+    windowWorstTicks = 0;
+    windowOversamplingTicks = 0;
+    windowCoreTicks = 0;
+}
+
+inline PerformanceStats::Snapshot PerformanceStats::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    snapshot.numSamples = numSamplesTotal.load(std::memory_order_relaxed);
+    snapshot.lastBlockMicros = lastBlockMicros.load(std::memory_order_relaxed);
+    snapshot.lastNanosPerSample = lastNanosPerSample.load(std::memory_order_relaxed);
+    snapshot.worstBlockMicros = worstBlockMicros.load(std::memory_order_relaxed);
+    snapshot.windowNanosPerSample = windowNanosPerSample.load(std::memory_order_relaxed);
+    snapshot.windowMicros = windowMicros.load(std::memory_order_relaxed);
+    snapshot.oversamplingMicros = oversamplingMicros.load(std::memory_order_relaxed);
+    snapshot.coreMicros = coreMicros.load(std::memory_order_relaxed);
+    snapshot.ringResizes = ringResizes.load(std::memory_order_relaxed);
+
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        snapshot.blockMicros[bucket] = blockHistogram[bucket].load(std::memory_order_relaxed);
+        snapshot.nanosPerSample[bucket] = sampleHistogram[bucket].load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+#endif
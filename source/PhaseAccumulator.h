@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// a phasor kept as a 64 bit fixed point fraction of a cycle.
+// unsigned overflow is the wrap, so there's no fmod, and adding an exact integer increment
+// every sample means the only error is the increment's rounding (< 2^-64 cycles per sample)
+class PhaseAccumulator {
+public:
+    PhaseAccumulator() = default;
+
+    void setFrequency(double frequency, double sampleRate) {
+        increment = sampleRate > 0.0 ? toFixed(frequency / sampleRate) : 0;
+    }
+
+    void reset(double newPhase = 0.0) { phase = toFixed(newPhase); }
+
+    // moves the phase on without filling anything, for blocks we skip
+    void advance(int64_t numSamples) { phase += increment * static_cast<uint64_t>(numSamples); }
+
+    double getPhase() const { return toDouble(phase); }
+
+    // writes the phase at each of the next numSamples samples into dest and moves past them
+    void fill(double* dest, int numSamples) {
+        uint64_t p = phase;
+        for (int i = 0; i < numSamples; ++i) {
+            dest[i] = toDouble(p);
+            p += increment;
+        }
+        phase = p;
+    }
+
+private:
+    uint64_t phase = 0;
+    uint64_t increment = 0;
+
+    // only the top 53 bits fit in a double. converting all 64 would round anything within 2^-54 of a cycle up to 1.0
+    static double toDouble(uint64_t fixed) { return static_cast<double>(fixed >> 11) * 0x1p-53; }
+
+    static uint64_t toFixed(double cycles) {
+        double fraction = cycles - std::floor(cycles);
+        if (!(fraction < 1.0))
+            fraction = 0.0;
+        return static_cast<uint64_t>(fraction * 0x1p64);
+    }
+};
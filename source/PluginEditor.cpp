@@ -48,6 +48,41 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     ratioSeparatorLabel.setColour(juce::Label::textColourId, Palette::text);
     addAndMakeVisible(ratioSeparatorLabel);
 
+    addAndMakeVisible(tempoSyncButton);
+    tempoSyncAttachment = std::make_unique<ButtonAttachment>(processorRef.parameters, "tempoSync", tempoSyncButton);
+
+    tempoDivisionBox.addItemList(TempoSync::getDivisionNames(), 1);
+    addAndMakeVisible(tempoDivisionBox);
+    tempoDivisionAttachment = std::make_unique<ComboBoxAttachment>(processorRef.parameters, "tempoDivision", tempoDivisionBox);
+
+    tempoLabel.setText("Tempo", juce::dontSendNotification);
+    tempoLabel.attachToComponent(&tempoDivisionBox, true);
+    addAndMakeVisible(tempoLabel);
+
+    interpolationBox.addItemList({ "Linear", "Hermite", "Lagrange", "Sinc" }, 1);
+    addAndMakeVisible(interpolationBox);
+    // the attachment picks the current item, so it has to come after the items exist
+    interpolationAttachment = std::make_unique<ComboBoxAttachment>(processorRef.parameters, "interpolation", interpolationBox);
+
+    interpolationLabel.setText("Interpolation", juce::dontSendNotification);
+    interpolationLabel.attachToComponent(&interpolationBox, true);
+    addAndMakeVisible(interpolationLabel);
+
+    addAndMakeVisible(polyphonyButton);
+    polyphonyAttachment = std::make_unique<ButtonAttachment>(processorRef.parameters, "polyphony", polyphonyButton);
+
+    oversamplingBox.addItemList({ "1x", "2x", "4x", "8x" }, 1);
+    addAndMakeVisible(oversamplingBox);
+    oversamplingAttachment = std::make_unique<ComboBoxAttachment>(processorRef.parameters, "oversampling", oversamplingBox);
+
+    oversamplingFilterBox.addItemList({ "IIR", "Linear Phase" }, 1);
+    addAndMakeVisible(oversamplingFilterBox);
+    oversamplingFilterAttachment = std::make_unique<ComboBoxAttachment>(processorRef.parameters, "oversamplingFilter", oversamplingFilterBox);
+
+    oversamplingLabel.setText("Oversampling", juce::dontSendNotification);
+    oversamplingLabel.attachToComponent(&oversamplingBox, true);
+    addAndMakeVisible(oversamplingLabel);
+
     frequencyLabel.setJustificationType(juce::Justification::centred);
     frequencyLabel.setColour(juce::Label::textColourId, Palette::text);
     frequencyLabel.setFont(juce::Font(14.0f));
@@ -55,6 +90,9 @@ PluginEditor::PluginEditor(PluginProcessor& p)
 
     startTimer(100);
 
+    scopeView = std::make_unique<ScopeView>(processorRef);
+    addAndMakeVisible(*scopeView);
+
     curveShapeEditor = std::make_unique<CurveShapeEditor>(processorRef);
     addAndMakeVisible(*curveShapeEditor);
 
@@ -68,7 +106,23 @@ PluginEditor::PluginEditor(PluginProcessor& p)
         inspector->setVisible(true);
     };
 
-    setSize(700, 600);
+#if HD_PERF_STATS
+    statsButton.setClickingTogglesState(true);
+    addAndMakeVisible(statsButton);
+    statsButton.onClick = [this] {
+        updateStatsLabel();
+        statsLabel.setVisible(statsButton.getToggleState());
+    };
+
+    statsLabel.setJustificationType(juce::Justification::topLeft);
+    statsLabel.setColour(juce::Label::textColourId, Palette::text);
+    statsLabel.setColour(juce::Label::backgroundColourId, Palette::mantle.withAlpha(0.85f));
+    statsLabel.setFont(juce::Font(12.0f));
+    statsLabel.setInterceptsMouseClicks(false, false);
+    addChildComponent(statsLabel);
+#endif
+
+    setSize(700, 850);
 }
 
 PluginEditor::~PluginEditor() {
@@ -89,7 +143,7 @@ void PluginEditor::resized() {
 
     area.removeFromTop(40);
 
-    auto controlArea = area.removeFromTop(200);
+    auto controlArea = area.removeFromTop(350);
 
     auto depthArea = controlArea.removeFromTop(50);
     depthLabel.setBounds(depthArea.removeFromLeft(80));
@@ -113,14 +167,39 @@ void PluginEditor::resized() {
     ratioSeparatorLabel.setBounds(slidersArea.removeFromLeft(20));
     denominatorSlider.setBounds(slidersArea);
 
+    auto tempoArea = controlArea.removeFromTop(50);
+    tempoLabel.setBounds(tempoArea.removeFromLeft(80));
+    tempoSyncButton.setBounds(tempoArea.removeFromRight(120));
+    tempoDivisionBox.setBounds(tempoArea.withSizeKeepingCentre(tempoArea.getWidth(), 24));
+
+    auto interpolationArea = controlArea.removeFromTop(50);
+    interpolationLabel.setBounds(interpolationArea.removeFromLeft(80));
+    polyphonyButton.setBounds(interpolationArea.removeFromRight(80));
+    interpolationBox.setBounds(interpolationArea.withSizeKeepingCentre(interpolationArea.getWidth(), 24));
+
+    auto oversamplingArea = controlArea.removeFromTop(50);
+    oversamplingLabel.setBounds(oversamplingArea.removeFromLeft(80));
+    int boxWidth = (oversamplingArea.getWidth() - 10) / 2;
+    oversamplingBox.setBounds(oversamplingArea.removeFromLeft(boxWidth).withSizeKeepingCentre(boxWidth, 24));
+    oversamplingArea.removeFromLeft(10);
+    oversamplingFilterBox.setBounds(oversamplingArea.withSizeKeepingCentre(oversamplingArea.getWidth(), 24));
+
     frequencyLabel.setBounds(area.removeFromTop(30));
 
+    if (scopeView)
+        scopeView->setBounds(area.removeFromTop(100));
+
     if (curveShapeEditor) {
         auto editorArea = area.removeFromTop(area.getHeight() - 40);
         curveShapeEditor->setBounds(editorArea);
     }
 
     inspectButton.setBounds(area.withSizeKeepingCentre(100, 40));
+
+#if HD_PERF_STATS
+    statsButton.setBounds(inspectButton.getBounds().translated(110, 0).withWidth(60));
+    statsLabel.setBounds(area.getRight() - 240, area.getY() - 84, 240, 80);
+#endif
 }
 
 void PluginEditor::sliderValueChanged(juce::Slider* slider) {
@@ -137,4 +216,25 @@ void PluginEditor::timerCallback() {
     }
 
     frequencyLabel.setText(freqText, juce::dontSendNotification);
+
+#if HD_PERF_STATS
+    if (statsLabel.isVisible())
+        updateStatsLabel();
+#endif
+}
+
+#if HD_PERF_STATS
+void PluginEditor::updateStatsLabel() {
+    auto stats = processorRef.getPerformanceStats();
+    auto share = [&](double micros) {
+        return stats.windowMicros > 0.0 ? juce::String(juce::roundToInt(100.0 * micros / stats.windowMicros)) + "%" : juce::String("-");
+    };
+
+    juce::String text;
+    text << "block " << juce::String(stats.lastBlockMicros / 1000.0, 2) << " ms, worst " << juce::String(stats.worstBlockMicros / 1000.0, 2) << " ms\n"
+         << juce::String(stats.windowNanosPerSample, 1) << " ns/sample\n"
+         << "oversampling " << share(stats.oversamplingMicros) << ", delay line " << share(stats.coreMicros) << "\n"
+         << "ring resizes " << juce::String(stats.ringResizes);
+    statsLabel.setText(text, juce::dontSendNotification);
 }
+#endif
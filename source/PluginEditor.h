@@ -3,6 +3,7 @@
 #include "CurveShapeEditor.h"
 #include "CustomLAF.h"
 #include "PluginProcessor.h"
+#include "ScopeView.h"
 #include "melatonin_inspector/melatonin_inspector.h"
 
 //==============================================================================
@@ -27,6 +28,12 @@ private:
     CustomLAF customLAF;
 
     juce::TextButton inspectButton { "Inspect" };
+#if HD_PERF_STATS
+    // the processor's performance counters, shown over the bottom of the curve editor
+    juce::TextButton statsButton { "Stats" };
+    juce::Label statsLabel;
+    void updateStatsLabel();
+#endif
     juce::Slider depthSlider;
     juce::Label depthLabel;
     juce::Slider syncSlider;
@@ -37,8 +44,18 @@ private:
     juce::Label ratioLabel;
     juce::Slider denominatorSlider;
     juce::Label ratioSeparatorLabel;
+    juce::ToggleButton tempoSyncButton { "Sync to Host" };
+    juce::ComboBox tempoDivisionBox;
+    juce::Label tempoLabel;
+    juce::ComboBox interpolationBox;
+    juce::Label interpolationLabel;
+    juce::ToggleButton polyphonyButton { "Poly" };
+    juce::ComboBox oversamplingBox;
+    juce::ComboBox oversamplingFilterBox;
+    juce::Label oversamplingLabel;
     juce::Label frequencyLabel;
     std::unique_ptr<CurveShapeEditor> curveShapeEditor;
+    std::unique_ptr<ScopeView> scopeView;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     std::unique_ptr<SliderAttachment> depthAttachment;
@@ -47,5 +64,15 @@ private:
     std::unique_ptr<SliderAttachment> numeratorAttachment;
     std::unique_ptr<SliderAttachment> denominatorAttachment;
 
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    std::unique_ptr<ComboBoxAttachment> interpolationAttachment;
+    std::unique_ptr<ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<ComboBoxAttachment> oversamplingFilterAttachment;
+    std::unique_ptr<ComboBoxAttachment> tempoDivisionAttachment;
+
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    std::unique_ptr<ButtonAttachment> polyphonyAttachment;
+    std::unique_ptr<ButtonAttachment> tempoSyncAttachment;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginEditor)
 };
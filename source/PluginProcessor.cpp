@@ -10,11 +10,32 @@ PluginProcessor::PluginProcessor()
               .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
               ),
-      parameters(*this, nullptr, "Parameters", { std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "depth", 1 }, "Depth", juce::NormalisableRange<float>(0.0f, 1.0f, 0.0f, 0.25f), 1.0f), std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "sync", 2 }, "Sync", juce::NormalisableRange<float>(1.0f, 32.0f, 0.0f), 1.0f), std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "dryWet", 3 }, "Dry/Wet", juce::NormalisableRange<float>(0.0f, 1.0f, 0.0f), 1.0f), std::make_unique<juce::AudioParameterInt>(juce::ParameterID { "numerator", 4 }, "Numerator", 1, 16, 1), std::make_unique<juce::AudioParameterInt>(juce::ParameterID { "denominator", 5 }, "Denominator", 1, 16, 1) }),
-      oversampling(2, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false) {
+      parameters(*this, nullptr, "Parameters", { std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "depth", 1 }, "Depth", juce::NormalisableRange<float>(0.0f, 1.0f, 0.0f, 0.25f), 1.0f), std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "sync", 2 }, "Sync", juce::NormalisableRange<float>(1.0f, 32.0f, 0.0f), 1.0f), std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { "dryWet", 3 }, "Dry/Wet", juce::NormalisableRange<float>(0.0f, 1.0f, 0.0f), 1.0f), std::make_unique<juce::AudioParameterInt>(juce::ParameterID { "numerator", 4 }, "Numerator", 1, 16, 1), std::make_unique<juce::AudioParameterInt>(juce::ParameterID { "denominator", 5 }, "Denominator", 1, 16, 1), std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "interpolation", 6 }, "Interpolation", juce::StringArray { "Linear", "Hermite", "Lagrange", "Sinc" }, 0), std::make_unique<juce::AudioParameterBool>(juce::ParameterID { "polyphony", 7 }, "Polyphony", false), std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "oversampling", 8 }, "Oversampling", juce::StringArray { "1x", "2x", "4x", "8x" }, 2), std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "oversamplingFilter", 9 }, "Oversampling Filter", juce::StringArray { "IIR", "Linear Phase" }, 0), std::make_unique<juce::AudioParameterBool>(juce::ParameterID { "tempoSync", 10 }, "Tempo Sync", false), std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { "tempoDivision", 11 }, "Tempo Division", TempoSync::getDivisionNames(), TempoSync::DEFAULT_DIVISION) }) {
+    depthParameter = parameters.getRawParameterValue("depth");
+    syncParameter = parameters.getRawParameterValue("sync");
+    dryWetParameter = parameters.getRawParameterValue("dryWet");
+    numeratorParameter = parameters.getRawParameterValue("numerator");
+    denominatorParameter = parameters.getRawParameterValue("denominator");
+    interpolationParameter = parameters.getRawParameterValue("interpolation");
+    polyphonyParameter = parameters.getRawParameterValue("polyphony");
+    oversamplingParameter = parameters.getRawParameterValue("oversampling");
+    oversamplingFilterParameter = parameters.getRawParameterValue("oversamplingFilter");
+    tempoSyncParameter = parameters.getRawParameterValue("tempoSync");
+    tempoDivisionParameter = parameters.getRawParameterValue("tempoDivision");
+
+    smoothedDepth.attach(depthParameter);
+    smoothedSync.attach(syncParameter);
+    smoothedDryWet.attach(dryWetParameter);
+
+    // build the sinc table here rather than the first time the audio thread asks for it
+    SincInterpolator::getTable<float>();
+    SincInterpolator::getTable<double>();
+
+    startTimerHz(MESSAGE_TIMER_HZ);
 }
 
 PluginProcessor::~PluginProcessor() {
+    stopTimer();
 }
 
 //==============================================================================
@@ -70,43 +91,145 @@ void PluginProcessor::changeProgramName(int index, const juce::String& newName)
 
 //==============================================================================
 void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
-
-    oversampling.initProcessing(samplesPerBlock);
-    oversampling.reset();
-
-    // its nice to have a big ring buffer it means u can play really low frequencies without artifacting
-    int maxDelaySamples = static_cast<int>(std::ceil(oversampling.getOversamplingFactor() * 16384));
+    maxBlockSize = samplesPerBlock;
+    splitMidi.ensureSize(4096);
+
+    auto profile = getQualityProfile();
+    activeOversampling = profile.oversampling;
+    activeInterpolation = profile.interpolation;
+    oversamplingFade = OversamplingFade::none;
+    oversampledRate = sampleRate * OversamplingSettings::getFactor(activeOversampling);
+
+    // the host picks the precision before preparing us, so only that path holds any memory
+    if (isUsingDoublePrecision()) {
+        preparePath(doublePath, samplesPerBlock);
+        releasePath(floatPath);
+    } else {
+        preparePath(floatPath, samplesPerBlock);
+        releasePath(doublePath);
+    }
 
-    ringBuffer.setSize(getTotalNumOutputChannels(), maxDelaySamples, false, true, false);
-    ringBuffer.clear();
     writePosition = 0;
+    pairWorkers.prepare((getTotalNumOutputChannels() + 1) / 2);
+
+    resizeControlBlocks(samplesPerBlock * OversamplingSettings::MAX_FACTOR);
+    scopeFeed.prepare(sampleRate, samplesPerBlock);
+#if HD_PERF_STATS
+    perfStats.prepare(sampleRate);
+#endif
+    voicePool.prepare(oversampledRate, samplesPerBlock * OversamplingSettings::MAX_FACTOR);
+    for (auto* smoothed : { &smoothedDepth, &smoothedSync, &smoothedDryWet })
+        smoothed->prepare(oversampledRate, samplesPerBlock * OversamplingSettings::MAX_FACTOR);
 
-    int oversamplingLatency = static_cast<int>(oversampling.getLatencyInSamples());
     setLatencySamples(oversamplingLatency);
+    bypassed = false;
+    skipProcessing = false;
+    tempoSync.reset();
+    // a fresh start, so nothing from whatever played before the last prepare leaks into the next render
+    midiToFreq.reset();
+    oscPhase.reset();
+}
+
+template <typename SampleType>
+void PluginProcessor::preparePath(AudioPath<SampleType>& path, int samplesPerBlock) {
+    // every oversampling setting gets prepared now, so changing quality later never allocates
+    int numChannels = getTotalNumOutputChannels();
+    path.oversamplers.prepare(numChannels, samplesPerBlock);
+    path.ringBuffer.prepare(numChannels, getWorstCaseRingSamples(oversampledRate));
+#if HD_PERF_STATS
+    seenRingGrows = path.ringBuffer.getNumGrows();
+#endif
+
+    int longestLatency = 0;
+    for (int setting = 0; setting < OversamplingSettings::NUM_SETTINGS; ++setting)
+        longestLatency = juce::jmax(longestLatency, path.oversamplers.getLatencySamples(setting));
+
+    oversamplingLatency = path.oversamplers.getLatencySamples(activeOversampling);
+    path.bypassDelay.prepare(numChannels, samplesPerBlock, longestLatency);
+    path.bypassDelay.setDelay(oversamplingLatency);
+}
+
+template <typename SampleType>
+void PluginProcessor::releasePath(AudioPath<SampleType>& path) {
+    path.oversamplers.release();
+    path.ringBuffer.release();
+    path.bypassDelay.prepare(0, 0, 0);
+}
+
+int PluginProcessor::getWorstCaseRingSamples(double rate) const {
+    // size the ring for the lowest note at the smallest numerator/denominator ratio up front,
+    // so playing it doesn't have to wait on the background thread to grow the buffer
+    auto numeratorRange = parameters.getParameterRange("numerator");
+    auto denominatorRange = parameters.getParameterRange("denominator");
+    double lowestRatio = numeratorRange.start / denominatorRange.end;
+    double worstCasePeriodSamples = rate / (WORST_CASE_LFO_FREQ * lowestRatio);
+    return static_cast<int>(std::ceil(worstCasePeriodSamples * 2)) + PairedDelayLine<float>::getRequiredHeadroom();
+}
+
+PluginProcessor::QualityProfile PluginProcessor::getQualityProfile() const {
+    if (isNonRealtime()) {
+        // bouncing, so cpu isn't the limit. a change of tier at prepareToPlay sets the latency there, one in the
+        // middle of a render goes through the same switch as the oversampling parameter
+        return { OversamplingSettings::getSetting(OversamplingSettings::NUM_FACTORS - 1, OversamplingSettings::Filter::linearPhase),
+            Interpolation::sinc,
+            OFFLINE_MIN_SMOOTHING_SECONDS };
+    }
+
+    int factorIndex = static_cast<int>(oversamplingParameter->load());
+    auto filter = static_cast<OversamplingSettings::Filter>(static_cast<int>(oversamplingFilterParameter->load()));
+    auto interpolation = static_cast<Interpolation>(static_cast<int>(interpolationParameter->load()));
+    return { OversamplingSettings::getSetting(factorIndex, filter), interpolation, 0.0 };
+}
+
+template <typename SampleType>
+void PluginProcessor::switchOversampling(int setting) {
+    auto& path = getPath<SampleType>();
+    activeOversampling = setting;
+    path.oversamplers.get(setting).reset();
+
+    oversampledRate = getSampleRate() * OversamplingSettings::getFactor(setting);
+    voicePool.setSampleRate(oversampledRate);
+    // a higher rate needs a longer line for the same notes, the background thread can start on it now
+    path.ringBuffer.ensureSize(getWorstCaseRingSamples(oversampledRate));
 
-    currentDepth = parameters.getRawParameterValue("depth")->load();
-    currentSync = parameters.getRawParameterValue("sync")->load();
-    currentDryWet = parameters.getRawParameterValue("dryWet")->load();
+    oversamplingLatency = path.oversamplers.getLatencySamples(setting);
+    path.bypassDelay.setDelay(oversamplingLatency);
+}
+
+void PluginProcessor::timerCallback() {
+    // message thread. posting from the audio thread could block, so the latency just waits here to be noticed
+    int latency = oversamplingLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    // same goes for the oscillator starting, the phase cursor waits on this rather than polling itself
+    bool moving = phaseSnapshot.read().isMoving(juce::Time::getMillisecondCounterHiRes());
+    if (moving && !phaseMoving)
+        phaseStarts.sendChangeMessage();
+    phaseMoving = moving;
 }
 
 void PluginProcessor::releaseResources() {
-    ringBuffer.setSize(0, 0);
+    pairWorkers.release();
+    floatPath.ringBuffer.release();
+    doublePath.ringBuffer.release();
     writePosition = 0;
 }
 
+void PluginProcessor::resizeControlBlocks(int numSamples) {
+    auto size = static_cast<size_t>(numSamples);
+    phaseBlock.resize(size);
+    lfoBlock.resize(size);
+    readOffsetBlock.resize(size);
+}
+
 bool PluginProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
 #if JucePlugin_IsMidiEffect
     juce::ignoreUnused(layouts);
     return true;
 #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // any layout works, channels are just taken in pairs. surround and ambisonic buses included
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -121,6 +244,27 @@ bool PluginProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
 
 void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     juce::MidiBuffer& midiMessages) {
+    processAnyBlock(buffer, midiMessages);
+}
+
+void PluginProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+    juce::MidiBuffer& midiMessages) {
+    processAnyBlock(buffer, midiMessages);
+}
+
+bool PluginProcessor::supportsDoublePrecisionProcessing() const {
+    return true;
+}
+
+template <typename SampleType>
+void PluginProcessor::processAnyBlock(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages) {
+    // only the path for the precision we were prepared with exists
+    jassert(isUsingDoublePrecision() == std::is_same_v<SampleType, double>);
+
+#if HD_PERF_STATS
+    auto statsStart = PerformanceStats::now();
+#endif
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -128,96 +272,272 @@ void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    midiToFreq.processMidiBuffer(midiMessages);
-    if (midiToFreq.wasNoteOn()) {
-        oscSamples = -midiMessages.getFirstEventTime();
+    // the position is for the start of the host block, TempoSync counts on from it if we split
+    auto* playHead = getPlayHead();
+    tempoSync.setPosition(playHead != nullptr ? playHead->getPosition() : juce::Optional<juce::AudioPlayHead::PositionInfo>());
+
+    // hosts can go over the block size they promised in prepareToPlay, in which case we take it in pieces
+    // rather than growing anything here
+    if (maxBlockSize <= 0 || buffer.getNumSamples() <= maxBlockSize) {
+        processHostBlock(buffer, midiMessages);
+    } else {
+        for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize) {
+            int numSamples = juce::jmin(maxBlockSize, buffer.getNumSamples() - start);
+            juce::AudioBuffer<SampleType> piece(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+            splitMidi.clear();
+            splitMidi.addEvents(midiMessages, start, numSamples, -start);
+            processHostBlock(piece, splitMidi);
+        }
+    }
+
+#if HD_PERF_STATS
+    int ringGrows = getPath<SampleType>().ringBuffer.getNumGrows();
+    perfStats.addRingResizes(ringGrows - seenRingGrows);
+    seenRingGrows = ringGrows;
+    perfStats.endBlock(statsStart, buffer.getNumSamples());
+#endif
+}
+
+template <typename SampleType>
+void PluginProcessor::processHostBlock(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages) {
+    auto& path = getPath<SampleType>();
+
+    // the oversamplers are all prepared, so a quality change only moves an index. the ring's history was written
+    // at the old rate and the new filters start empty, so the output ducks out for a block and back in after
+    auto profile = getQualityProfile();
+    if (oversamplingFade == OversamplingFade::out) {
+        switchOversampling<SampleType>(profile.oversampling);
+        oversamplingFade = OversamplingFade::in;
+    } else if (oversamplingFade == OversamplingFade::none && profile.oversampling != activeOversampling) {
+        oversamplingFade = OversamplingFade::out;
     }
-    double baseFreq = midiToFreq.getCurrentFrequency().value_or(1.0);
+    activeInterpolation = profile.interpolation;
 
     // Apply numerator/denominator multiplier
-    int numerator = parameters.getRawParameterValue("numerator")->load();
-    int denominator = parameters.getRawParameterValue("denominator")->load();
-    oscFreq = baseFreq * (static_cast<double>(numerator) / static_cast<double>(denominator));
+    int numerator = static_cast<int>(numeratorParameter->load());
+    int denominator = static_cast<int>(denominatorParameter->load());
+    oscRatio = static_cast<double>(numerator) / static_cast<double>(denominator);
+    oversampledRate = getSampleRate() * OversamplingSettings::getFactor(activeOversampling);
+
+    bool wasTempoSynced = tempoSynced;
+    tempoSynced = tempoSyncParameter->load() >= 0.5f;
+    if (tempoSynced) {
+        if (!wasTempoSynced)
+            tempoSync.reset();
+        tempoSync.beginBlock(static_cast<int>(tempoDivisionParameter->load()), oscRatio, buffer.getNumSamples(), getSampleRate());
+    }
+    updateOscillatorFrequency();
+    voicePool.setRatio(oscRatio);
+
+    // glides are timed in seconds at the oversampled rate, so they take as long however the host splits its blocks
+    auto shape = smoothingShape.load(std::memory_order_relaxed);
+    double seconds = juce::jmax(smoothingSeconds.load(std::memory_order_relaxed), profile.minSmoothingSeconds);
+    for (auto* smoothed : { &smoothedDepth, &smoothedSync, &smoothedDryWet }) {
+        smoothed->setSampleRate(oversampledRate);
+        smoothed->setSmoothing(shape, seconds);
+        smoothed->update();
+    }
 
-    frequency.write() = oscFreq;
-    frequency.mark_dirty();
+    // inert once dry/wet has glided all the way to 0, and not while a quality switch is waiting on a full render
+    bool inert = !smoothedDryWet.isSmoothing() && smoothedDryWet.getCurrent() == 0.0f && oversamplingFade == OversamplingFade::none
+                 && profile.oversampling == activeOversampling;
+    path.bypassDelay.push(buffer);
+    skipProcessing = bypassed && inert;
+    scopeActive = scopeFeed.beginBlock(buffer.getNumSamples());
+
+    if (bypassed && !inert) {
+        // coming back: the filters start from silence, and so does the line if the background thread had time
+        // to clear one, otherwise the history is from just before we went idle
+        path.oversamplers.get(activeOversampling).reset();
+        path.ringBuffer.takeCleared();
+    }
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::AudioBlock<float> oversampledBlock = oversampling.processSamplesUp(block);
-    int oversampledNumSamples = static_cast<int>(oversampledBlock.getNumSamples());
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+
+    // render up to each event, then apply it, so note ons, bends and transport resyncs land on their sample
+    size_t rangeStart = 0;
+    int numResyncs = tempoSynced ? tempoSync.getNumResyncs() : 0;
+    int nextResync = 0;
+    auto renderUpTo = [&](size_t end) {
+        for (; nextResync < numResyncs && static_cast<size_t>(tempoSync.getResync(nextResync).sample) <= end; ++nextResync) {
+            const auto& resync = tempoSync.getResync(nextResync);
+            auto resyncTime = static_cast<size_t>(resync.sample);
+            if (resyncTime > rangeStart) {
+                processRange(block, rangeStart, resyncTime - rangeStart);
+                rangeStart = resyncTime;
+            }
+            oscPhase.reset(resync.phase);
+        }
 
-    float targetDepth = parameters.getRawParameterValue("depth")->load();
-    float targetSync = parameters.getRawParameterValue("sync")->load();
-    float targetDryWet = parameters.getRawParameterValue("dryWet")->load();
+        if (end > rangeStart) {
+            processRange(block, rangeStart, end - rangeStart);
+            rangeStart = end;
+        }
+    };
 
-    float depthIncrement = (targetDepth - currentDepth) / oversampledNumSamples;
-    float syncIncrement = (targetSync - currentSync) / oversampledNumSamples;
-    float dryWetIncrement = (targetDryWet - currentDryWet) / oversampledNumSamples;
+    for (const auto metadata : midiMessages) {
+        renderUpTo(static_cast<size_t>(juce::jlimit(0, buffer.getNumSamples(), metadata.samplePosition)));
+        handleMidiEvent(metadata.getMessage());
+    }
+    renderUpTo(block.getNumSamples());
+
+    if (skipProcessing) {
+        path.bypassDelay.mixInto(buffer, 1, 1);
+    } else if (inert) {
+        path.bypassDelay.mixInto(buffer, 0, 1);
+        bypassed = true;
+        path.ringBuffer.requestCleared();
+    } else if (bypassed) {
+        path.bypassDelay.mixInto(buffer, 1, 0);
+        bypassed = false;
+    }
 
-    double oversampledRate = getSampleRate() * oversampling.getOversamplingFactor();
-    double oscPeriodSamples = oversampledRate / oscFreq;
+    if (oversamplingFade == OversamplingFade::out) {
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 1, 0);
+    } else if (oversamplingFade == OversamplingFade::in) {
+        buffer.applyGainRamp(0, buffer.getNumSamples(), 0, 1);
+        oversamplingFade = OversamplingFade::none;
+    }
 
-    int ringBufferSize = ringBuffer.getNumSamples();
+    if (scopeActive)
+        scopeFeed.endBlock(path.bypassDelay, buffer);
+
+    auto& snapshot = phaseSnapshot.write();
+    if (isPolyphonic()) {
+        snapshot.phase = voicePool.getNewestPhase();
+        snapshot.running = voicePool.hasActiveVoices();
+        snapshot.frequency = snapshot.running ? voicePool.getNewestFrequency() : oscFreq;
+    } else {
+        snapshot.phase = oscPhase.getPhase();
+        snapshot.frequency = oscFreq;
+        snapshot.running = !tempoSynced || tempoSync.isPlaying();
+    }
+    snapshot.timeMs = juce::Time::getMillisecondCounterHiRes();
+    phaseSnapshot.publish();
+}
 
-    if (ringBufferSize > 0 && ringBuffer.getNumChannels() > 0) {
-        int requiredRingBufferSamples = (int) std::ceil(oscPeriodSamples * 2);
-        if (ringBuffer.getNumSamples() < requiredRingBufferSamples) {
-            // allocates but should be rare
-            ringBuffer.setSize(getTotalNumOutputChannels(), requiredRingBufferSamples, true);
-            ringBufferSize = requiredRingBufferSamples;
-        }
+void PluginProcessor::handleMidiEvent(const juce::MidiMessage& msg) {
+    // the voices follow midi even in mono mode so switching over picks up whatever's held
+    voicePool.processMidiMessage(msg);
 
-        for (size_t channel = 0; channel < oversampledBlock.getNumChannels(); ++channel) {
-            auto* channelData = oversampledBlock.getChannelPointer(channel);
-            auto* ringData = ringBuffer.getWritePointer(static_cast<int>(channel));
-            int localWritePos = writePosition;
-
-            for (int sample = 0; sample < oversampledNumSamples; ++sample) {
-                int64_t localSamples = oscSamples + sample;
-
-                float drySample = channelData[sample];
-                ringData[localWritePos] = drySample;
-
-                auto localPhase = std::fmod(localSamples / oscPeriodSamples, 1.0);
-                if (localPhase < 0.0)
-                    localPhase += 1.0;
-
-                // interpolate parameters per-sample
-                float depthValue = currentDepth + depthIncrement * sample;
-                float syncValue = currentSync + syncIncrement * sample;
-                float dryWetValue = currentDryWet + dryWetIncrement * sample;
-
-                // TODO: we should be able to calculate a block of transfer values ahead of time
-                double lfoValue = (double) tf.getValue(localPhase, depthValue, syncValue);
-
-                double readOffset = oscPeriodSamples * lfoValue - std::fmod((double) localSamples, oscPeriodSamples) - oscPeriodSamples;
-                double readPos = localWritePos + readOffset;
-                int readSampleIdxA = ((int) std::floor(readPos)) % ringBufferSize;
-                int readSampleIdxB = ((int) std::ceil(readPos)) % ringBufferSize;
-                if (readSampleIdxA < 0)
-                    readSampleIdxA += ringBufferSize;
-                if (readSampleIdxB < 0)
-                    readSampleIdxB += ringBufferSize;
-                auto delayedSample = (float) std::lerp(ringData[readSampleIdxA], ringData[readSampleIdxB], std::fmod(readPos, 1.0));
-                channelData[sample] = drySample * (1.0f - dryWetValue) + delayedSample * dryWetValue;
-
-                localWritePos++;
-                localWritePos %= ringBufferSize;
-            }
-        }
+    if (midiToFreq.processMidiMessage(msg) && !tempoSynced) {
+        // we're split at the note on, so phase 0 belongs right here
+        oscPhase.reset();
+    }
 
-        writePosition = (writePosition + oversampledNumSamples) % ringBufferSize;
-        oscSamples += oversampledNumSamples;
+    updateOscillatorFrequency();
+}
+
+void PluginProcessor::updateOscillatorFrequency() {
+    // tempo synced, notes don't move the oscillator at all
+    if (tempoSynced)
+        oscFreq = tempoSync.getFrequency();
+    else
+        oscFreq = midiToFreq.getCurrentFrequency().value_or(1.0) * oscRatio;
+    oscPhase.setFrequency(oscFreq, oversampledRate);
+}
+
+bool PluginProcessor::isPolyphonic() const {
+    // voices follow notes, so they've nothing to do while the host's tempo drives the lfo
+    return !tempoSynced && polyphonyParameter->load() >= 0.5f && voicePool.hasActiveVoices();
+}
+
+template <typename SampleType>
+void PluginProcessor::processRange(juce::dsp::AudioBlock<SampleType>& block, size_t startSample, size_t numSamples) {
+    if (numSamples == 0)
+        return;
+
+    if (skipProcessing) {
+        // nothing to render, but the oscillators and glides keep going so coming back lands where it would have
+        int oversampledNumSamples = static_cast<int>(numSamples) * OversamplingSettings::getFactor(activeOversampling);
+        oscPhase.advance(oversampledNumSamples);
+        if (isPolyphonic())
+            voicePool.advance(oversampledNumSamples);
+        for (auto* smoothed : { &smoothedDepth, &smoothedSync, &smoothedDryWet })
+            smoothed->skip(oversampledNumSamples);
+        return;
     }
 
-    phasor.write() = std::fmod(oscSamples / oscPeriodSamples, 1.0);
-    phasor.mark_dirty();
+    auto subBlock = block.getSubBlock(startSample, numSamples);
+    processSubBlock(subBlock, isPolyphonic());
+
+    // the offsets this range was read with are still in readOffsetBlock
+    if (scopeActive) {
+        int factor = OversamplingSettings::getFactor(activeOversampling);
+        scopeFeed.captureOffsets(static_cast<int>(startSample), readOffsetBlock.data(), static_cast<int>(numSamples), factor);
+    }
+}
+
+template <typename SampleType>
+void PluginProcessor::processSubBlock(juce::dsp::AudioBlock<SampleType>& block, bool polyphonic) {
+    auto& path = getPath<SampleType>();
+    auto& oversampler = path.oversamplers.get(activeOversampling);
+#if HD_PERF_STATS
+    auto upStart = PerformanceStats::now();
+#endif
+    juce::dsp::AudioBlock<SampleType> oversampledBlock = oversampler.processSamplesUp(block);
+    int oversampledNumSamples = static_cast<int>(oversampledBlock.getNumSamples());
+#if HD_PERF_STATS
+    auto coreStart = PerformanceStats::now();
+    perfStats.addOversampling(coreStart - upStart);
+#endif
+
+    double oscPeriodSamples = oversampledRate / oscFreq;
 
-    currentDepth = targetDepth;
-    currentSync = targetSync;
-    currentDryWet = targetDryWet;
+    // once per block for every channel, and nothing to do while they're not moving
+    const float* depths = smoothedDepth.render(oversampledNumSamples);
+    const float* syncs = smoothedSync.render(oversampledNumSamples);
+    const float* dryWets = smoothedDryWet.render(oversampledNumSamples);
+
+    auto& line = path.ringBuffer.getLine(writePosition, oversampledNumSamples);
+
+    if (line.getNumSamples() > 0 && line.getNumChannels() > 0) {
+        // if this note needs more than we sized for, the background thread grows the line and in the meantime
+        // we clamp the delay to what we've got
+        double longestPeriodSamples = polyphonic ? voicePool.getLongestPeriodSamples() : oscPeriodSamples;
+        // slow tempos at long divisions could ask for minutes, past MAX_RING_SECONDS the delay just stays clamped
+        double ringSeconds = juce::jmin(longestPeriodSamples * 2 / oversampledRate, MAX_RING_SECONDS);
+        int requiredRingBufferSamples = (int) std::ceil(ringSeconds * oversampledRate) + line.getRequiredHeadroom();
+        path.ringBuffer.ensureSize(requiredRingBufferSamples);
+        double longestOffset = -static_cast<double>(line.getNumSamples() - line.getRequiredHeadroom());
+
+        if (polyphonic) {
+            voicePool.renderReadOffsets(tf, depths, syncs, readOffsetBlock.data(), oversampledNumSamples);
+            // keep the mono oscillator moving so switching back doesn't jump
+            oscPhase.advance(oversampledNumSamples);
+        } else {
+            oscPhase.fill(phaseBlock.data(), oversampledNumSamples);
+            tf.getValues(phaseBlock.data(), depths, syncs, oscPeriodSamples, lfoBlock.data(), oversampledNumSamples);
+
+            for (int sample = 0; sample < oversampledNumSamples; ++sample)
+                readOffsetBlock[sample] = oscPeriodSamples * ((double) lfoBlock[sample] - phaseBlock[sample] - 1.0);
+        }
+
+        for (int sample = 0; sample < oversampledNumSamples; ++sample)
+            readOffsetBlock[sample] = std::max(readOffsetBlock[sample], longestOffset);
+
+        // both channels of a pair go through together, a lone channel is paired with itself.
+        // the read offsets above are shared, so pairs are independent and big buses spread them over the workers
+        int numChannels = static_cast<int>(oversampledBlock.getNumChannels());
+        int numPairs = juce::jmin((numChannels + 1) / 2, line.getNumPairs());
+        auto processPair = [&](int pair) {
+            auto* left = oversampledBlock.getChannelPointer(static_cast<size_t>(pair * 2));
+            auto* right = pair * 2 + 1 < numChannels ? oversampledBlock.getChannelPointer(static_cast<size_t>(pair * 2 + 1)) : left;
+            line.processPair(activeInterpolation, pair, writePosition, left, right, readOffsetBlock.data(), dryWets, oversampledNumSamples);
+        };
+        pairWorkers.run(numPairs, processPair);
+
+        writePosition = line.wrap(writePosition + oversampledNumSamples);
+    }
 
-    oversampling.processSamplesDown(block);
+#if HD_PERF_STATS
+    auto downStart = PerformanceStats::now();
+    perfStats.addCore(downStart - coreStart);
+#endif
+    oversampler.processSamplesDown(block);
+#if HD_PERF_STATS
+    perfStats.addOversampling(PerformanceStats::now() - downStart);
+#endif
 }
 
 //==============================================================================
@@ -248,7 +568,7 @@ void PluginProcessor::getStateInformation(juce::MemoryBlock& destData) {
     }
 
     juce::ValueTree nodesTree("ControlNodes");
-    const auto& nodes = tf.nodes().read();
+    const auto& nodes = tf.getControlNodes();
 
     for (const auto& node : nodes) {
         juce::ValueTree nodeTree("Node");
@@ -297,8 +617,7 @@ void PluginProcessor::setStateInformation(const void* data, int sizeInBytes) {
     parameters.replaceState(state);
 
     if (!savedNodes.empty()) {
-        std::stable_sort(savedNodes.begin(), savedNodes.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
-        tf.nodes().setAll(savedNodes);
+        tf.setControlNodes(savedNodes);
     }
 
     if (lastFrequency >= 0.0) {
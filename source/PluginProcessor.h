@@ -1,18 +1,31 @@
 #pragma once
 
-#include "DoubleBuffer.h"
+#include "GrowableDelayLine.h"
+#include "LatencyDelay.h"
 #include "MidiToFrequency.h"
+#include "OversamplerBank.h"
+#include "PairWorkerPool.h"
+#include "PerformanceStats.h"
+#include "PhaseAccumulator.h"
+#include "ScopeFeed.h"
+#include "SmoothedParameter.h"
+#include "TempoSync.h"
 #include "TransferFunction.h"
+#include "TripleBuffer.h"
+#include "VoicePool.h"
 #include <algorithm>
+#include <atomic>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include <type_traits>
 #include <vector>
 
 #if (MSVC)
     #include "ipps.h"
 #endif
 
-class PluginProcessor : public juce::AudioProcessor {
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::Timer {
 public:
     PluginProcessor();
     ~PluginProcessor() override;
@@ -23,6 +36,8 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -51,40 +66,197 @@ public:
             param->setValueNotifyingHost(parameters.getParameterRange("gain").convertTo0to1(juce::jlimit(0.0f, 2.0f, newGain)));
     }
 
-    double getPhase() { return phasor.read(); }
-    double getCurrentFrequency() { return frequency.read(); }
+    // where the oscillator the ui follows was at the end of the last block, and how fast it was going, so
+    // the ui can carry it on between blocks instead of stepping once per block
+    struct PhaseSnapshot {
+        double phase = 0.0;
+        double frequency = 1.0;
+        // juce::Time::getMillisecondCounterHiRes() when it was published
+        double timeMs = 0.0;
+        // false while the oscillator is stopped - no voices held, or synced to a transport that isn't playing
+        bool running = false;
 
-    float getCurveValue(float phase) {
-        float depth = parameters.getRawParameterValue("depth")->load();
-        float sync = parameters.getRawParameterValue("sync")->load();
-        return tf.getValue(phase, depth, sync);
+        // a snapshot this old means blocks have stopped coming, the host has paused us or stopped its engine
+        static constexpr double STALE_MS = 250.0;
+        bool isMoving(double nowMs) const { return running && nowMs - timeMs <= STALE_MS; }
+    };
+
+    // ui thread - these are the reading end of buffers the audio thread publishes to
+    PhaseSnapshot getPhaseSnapshot() { return phaseSnapshot.read(); }
+    double getCurrentFrequency() { return phaseSnapshot.read().frequency; }
+
+    // ui thread - listeners hear from the message loop when the oscillator starts moving, so nothing has to
+    // poll for it while it's stopped. adding one counts the oscillator as stopped until the timer next looks
+    void addPhaseStartListener(juce::ChangeListener* listener) {
+        phaseStarts.addChangeListener(listener);
+        phaseMoving = false;
+    }
+    void removePhaseStartListener(juce::ChangeListener* listener) { phaseStarts.removeChangeListener(listener); }
+
+    // ui thread
+    float getCurveValue(float phase) const {
+        return tf.getValue(phase, depthParameter->load(), syncParameter->load());
+    }
+    float getDepth() const { return depthParameter->load(); }
+    float getSync() const { return syncParameter->load(); }
+
+    // any thread - how depth, sync and dry/wet glide to a new value, picked up at the next block.
+    // offline renders never glide quicker than the quality profile's minimum
+    void setParameterSmoothing(SmoothedParameter::Shape shape, double seconds) {
+        smoothingShape = shape;
+        smoothingSeconds = juce::jmax(0.0, seconds);
     }
 
     TransferFunction& getTF() { return tf; }
     const TransferFunction& getTF() const { return tf; }
 
+    // the reading end is the editor's scope, which turns it on while it's open
+    ScopeFeed& getScopeFeed() { return scopeFeed; }
+
+#if HD_PERF_STATS
+    // any thread - what processBlock has been costing, see PerformanceStats
+    PerformanceStats::Snapshot getPerformanceStats() const { return perfStats.getSnapshot(); }
+#endif
+
 private:
     static constexpr double WORST_CASE_LFO_FREQ = 8.176; // C-1 (MIDI note 0)
+    // the longest the ring grows to on demand
+    static constexpr double MAX_RING_SECONDS = 20.0;
 
     juce::UndoManager undoManager;
     TransferFunction tf;
-    DoubleBuffer<double> phasor { 0.0 };
-    DoubleBuffer<double> frequency { 1.0 };
+    TripleBuffer<PhaseSnapshot> phaseSnapshot { PhaseSnapshot() };
+    // message thread - what the timer last saw of the oscillator, so it only tells listeners when it starts
+    juce::ChangeBroadcaster phaseStarts;
+    bool phaseMoving = false;
+    ScopeFeed scopeFeed;
+    // whether scopeFeed wants this host block
+    bool scopeActive = false;
+
+#if HD_PERF_STATS
+    PerformanceStats perfStats;
+    // the ring's grow count at the end of the last block, so each block adds only its own
+    int seenRingGrows = 0;
+#endif
 
     double oscFreq = 1.0;
-    // we store the phasor in integer samples so we can't lose precision
-    int64_t oscSamples = 0;
+    double oscRatio = 1.0;
+    double oversampledRate = 44100.0;
+    // fixed point so the phasor can't drift no matter how long we run
+    PhaseAccumulator oscPhase;
+
+    // everything that holds audio, once per sample type. only the one for the precision the host picked
+    // gets prepared, the other stays empty
+    template <typename SampleType>
+    struct AudioPath {
+        OversamplerBank<SampleType> oversamplers;
+        GrowableDelayLine<SampleType> ringBuffer;
+        // with dryWet parked at 0 nothing we do is audible, so we skip oversampling and the delay line and pass
+        // the input through a pure delay that matches our latency. going in and out crossfades over a block
+        LatencyDelay<SampleType> bypassDelay;
+    };
+
+    AudioPath<float> floatPath;
+    AudioPath<double> doublePath;
+
+    template <typename SampleType>
+    AudioPath<SampleType>& getPath() {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doublePath;
+        else
+            return floatPath;
+    }
 
-    juce::AudioBuffer<float> ringBuffer;
     int writePosition = 0;
+    // big buses split their pairs over a few threads
+    PairWorkerPool pairWorkers;
+
+    // per-sample control values for the oversampled block, shared by every channel. depth, sync and dry/wet
+    // render into their SmoothedParameter's own buffer
+    std::vector<double> phaseBlock;
+    std::vector<float> lfoBlock;
+    std::vector<double> readOffsetBlock;
+
+    // host samples, the control blocks are sized for this at the highest oversampling factor
+    int maxBlockSize = 0;
+    // bigger host blocks are split into pieces no longer than maxBlockSize, each with its share of the midi
+    juce::MidiBuffer splitMidi;
+
+    bool bypassed = false;
+    bool skipProcessing = false;
+
+    void resizeControlBlocks(int numSamples);
+    int getWorstCaseRingSamples(double rate) const;
+    void handleMidiEvent(const juce::MidiMessage& msg);
+    void updateOscillatorFrequency();
+    bool isPolyphonic() const;
+
+    template <typename SampleType>
+    void preparePath(AudioPath<SampleType>& path, int samplesPerBlock);
+    template <typename SampleType>
+    void releasePath(AudioPath<SampleType>& path);
+
+    // one processing core for both precisions, everything from here down is templated on the sample type
+    template <typename SampleType>
+    void processAnyBlock(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    template <typename SampleType>
+    void processHostBlock(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    template <typename SampleType>
+    void processRange(juce::dsp::AudioBlock<SampleType>& block, size_t startSample, size_t numSamples);
+    template <typename SampleType>
+    void processSubBlock(juce::dsp::AudioBlock<SampleType>& block, bool polyphonic);
 
     MidiToFrequency midiToFreq;
+    VoicePool voicePool;
+    // with tempo sync on the host's transport drives the oscillator instead of midi
+    TempoSync tempoSync;
+    bool tempoSynced = false;
+
+    int activeOversampling = 0;
+    // a quality change ducks out over one block, switches, and fades back in over the next
+    enum class OversamplingFade { none, out, in };
+    OversamplingFade oversamplingFade = OversamplingFade::none;
+    // the latency of the active setting. the audio thread only stores it, the message thread's timer
+    // notices it differs from what the host was told and reports it. the same timer watches for the
+    // oscillator starting
+    std::atomic<int> oversamplingLatency { 0 };
+    static constexpr int MESSAGE_TIMER_HZ = 10;
+
+    // what we render with: the quality parameters when live, the best we have when the host bounces offline
+    struct QualityProfile {
+        int oversampling;
+        Interpolation interpolation;
+        // depth, sync and dry/wet glide over at least this long, whatever setParameterSmoothing() asked for
+        double minSmoothingSeconds;
+    };
+    static constexpr double OFFLINE_MIN_SMOOTHING_SECONDS = 0.02;
+
+    QualityProfile getQualityProfile() const;
+    Interpolation activeInterpolation = Interpolation::linear;
+    template <typename SampleType>
+    void switchOversampling(int setting);
+    void timerCallback() override;
 
-    juce::dsp::Oversampling<float> oversampling;
+    // looked up by name once, in the constructor
+    std::atomic<float>* depthParameter = nullptr;
+    std::atomic<float>* syncParameter = nullptr;
+    std::atomic<float>* dryWetParameter = nullptr;
+    std::atomic<float>* numeratorParameter = nullptr;
+    std::atomic<float>* denominatorParameter = nullptr;
+    std::atomic<float>* interpolationParameter = nullptr;
+    std::atomic<float>* polyphonyParameter = nullptr;
+    std::atomic<float>* oversamplingParameter = nullptr;
+    std::atomic<float>* oversamplingFilterParameter = nullptr;
+    std::atomic<float>* tempoSyncParameter = nullptr;
+    std::atomic<float>* tempoDivisionParameter = nullptr;
 
-    float currentDepth = 0.0f;
-    float currentSync = 1.0f;
-    float currentDryWet = 1.0f;
+    // counted in oversampled samples
+    SmoothedParameter smoothedDepth;
+    SmoothedParameter smoothedSync;
+    SmoothedParameter smoothedDryWet;
+    static constexpr double DEFAULT_SMOOTHING_SECONDS = 0.01;
+    std::atomic<SmoothedParameter::Shape> smoothingShape { SmoothedParameter::Shape::linear };
+    std::atomic<double> smoothingSeconds { DEFAULT_SMOOTHING_SECONDS };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor)
 };
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "LatencyDelay.h"
+#include <algorithm>
+#include <atomic>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <limits>
+#include <vector>
+
+// what the scope in the editor draws, sent from the audio thread through a single producer, single consumer fifo.
+// the first channel's input (lined up with the output through the bypass delay), its output and the read offset
+// are boiled down to a min and max per few samples, so the ui only ever sees a couple of thousand frames a second.
+// nothing is allocated or locked on the audio thread, and with no scope open all it does is check one flag a block
+class ScopeFeed {
+public:
+    struct Frame {
+        float dryMin, dryMax;
+        float wetMin, wetMax;
+        // host samples behind the write position, so never positive
+        float offsetMin, offsetMax;
+    };
+
+    static constexpr int FIFO_FRAMES = 4096;
+    static constexpr double FRAMES_PER_SECOND = 2000.0;
+
+    ScopeFeed()
+        : frames(static_cast<size_t>(FIFO_FRAMES)) {
+    }
+
+    // allocates
+    void prepare(double sampleRate, int maxBlockSize) {
+        offsets.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+        samplesPerFrame = juce::jmax(1, juce::roundToInt(sampleRate / FRAMES_PER_SECOND));
+        startFrame();
+    }
+
+    // ui thread - the scope turns this on while it's open. anything left over from last time is thrown away
+    void setEnabled(bool shouldBeEnabled) {
+        if (shouldBeEnabled)
+            fifo.finishedRead(fifo.getNumReady());
+        enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+    }
+
+    // audio thread - once at the start of a host block, whether the other calls are going to do anything
+    bool beginBlock(int numSamples) {
+        bool wasActive = active;
+        active = enabled.load(std::memory_order_relaxed);
+        if (!active)
+            return false;
+
+        // off for a while, so whatever we were halfway through is long gone
+        if (!wasActive)
+            startFrame();
+
+        std::fill(offsets.begin(), offsets.begin() + juce::jmin(numSamples, static_cast<int>(offsets.size())), 0.0f);
+        return true;
+    }
+
+    // audio thread - the read offsets for a stretch of the block starting startSample host samples in, at the
+    // oversampled rate. ranges that don't render leave theirs at 0
+    void captureOffsets(int startSample, const double* oversampledOffsets, int numSamples, int factor) {
+        if (!active)
+            return;
+
+        numSamples = juce::jmin(numSamples, static_cast<int>(offsets.size()) - startSample);
+        for (int i = 0; i < numSamples; ++i)
+            offsets[static_cast<size_t>(startSample + i)] = static_cast<float>(oversampledOffsets[i * factor] / factor);
+    }
+
+    // audio thread - once the block's output is final
+    template <typename SampleType>
+    void endBlock(const LatencyDelay<SampleType>& dry, const juce::AudioBuffer<SampleType>& wet) {
+        if (!active || dry.getNumChannels() == 0 || wet.getNumChannels() == 0)
+            return;
+
+        const auto* output = wet.getReadPointer(0);
+        int numSamples = juce::jmin(wet.getNumSamples(), static_cast<int>(offsets.size()));
+        for (int i = 0; i < numSamples; ++i) {
+            auto drySample = static_cast<float>(dry.getDelayedSample(0, i));
+            auto wetSample = static_cast<float>(output[i]);
+            float offset = offsets[static_cast<size_t>(i)];
+
+            current.dryMin = std::min(current.dryMin, drySample);
+            current.dryMax = std::max(current.dryMax, drySample);
+            current.wetMin = std::min(current.wetMin, wetSample);
+            current.wetMax = std::max(current.wetMax, wetSample);
+            current.offsetMin = std::min(current.offsetMin, offset);
+            current.offsetMax = std::max(current.offsetMax, offset);
+
+            if (++samplesInFrame == samplesPerFrame) {
+                // a ui that isn't keeping up just misses frames
+                auto scope = fifo.write(1);
+                if (scope.blockSize1 > 0)
+                    frames[static_cast<size_t>(scope.startIndex1)] = current;
+                startFrame();
+            }
+        }
+    }
+
+    // ui thread - up to maxFrames of the oldest frames not read yet, returns how many
+    int pull(Frame* dest, int maxFrames) {
+        auto scope = fifo.read(juce::jmin(maxFrames, fifo.getNumReady()));
+        std::copy_n(frames.begin() + scope.startIndex1, scope.blockSize1, dest);
+        std::copy_n(frames.begin() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    juce::AbstractFifo fifo { FIFO_FRAMES };
+    std::vector<Frame> frames;
+    std::atomic<bool> enabled { false };
+
+    // audio thread owned
+    bool active = false;
+    std::vector<float> offsets;
+    int samplesPerFrame = 1;
+    int samplesInFrame = 0;
+    Frame current {};
+
+    void startFrame() {
+        constexpr float big = std::numeric_limits<float>::max();
+        current = { big, -big, big, -big, big, -big };
+        samplesInFrame = 0;
+    }
+};
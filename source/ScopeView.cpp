@@ -0,0 +1,84 @@
+#include "ScopeView.h"
+#include "Palette.h"
+
+ScopeView::ScopeView(PluginProcessor& processor)
+    : processorRef(processor),
+      history(static_cast<size_t>(MAX_HISTORY)),
+      incoming(static_cast<size_t>(ScopeFeed::FIFO_FRAMES)) {
+    setInterceptsMouseClicks(false, false);
+    processorRef.getScopeFeed().setEnabled(true);
+    startTimerHz(30);
+}
+
+ScopeView::~ScopeView() {
+    stopTimer();
+    processorRef.getScopeFeed().setEnabled(false);
+}
+
+void ScopeView::timerCallback() {
+    int numPulled = processorRef.getScopeFeed().pull(incoming.data(), static_cast<int>(incoming.size()));
+    if (numPulled == 0)
+        return;
+
+    for (int i = 0; i < numPulled; ++i) {
+        history[static_cast<size_t>((historyStart + historySize) % MAX_HISTORY)] = incoming[static_cast<size_t>(i)];
+        if (historySize < MAX_HISTORY)
+            ++historySize;
+        else
+            historyStart = (historyStart + 1) % MAX_HISTORY;
+    }
+
+    repaint();
+}
+
+void ScopeView::paint(juce::Graphics& g) {
+    auto area = getLocalBounds();
+    g.setColour(Palette::surface0);
+    g.fillRect(area);
+    g.setColour(Palette::overlay0);
+    g.drawRect(area, 1);
+
+    area.reduce(2, 2);
+    auto waveArea = area.removeFromTop(area.getHeight() * 2 / 3).toFloat();
+    auto offsetArea = area.toFloat();
+
+    g.setColour(Palette::overlay0.withAlpha(0.5f));
+    g.drawHorizontalLine((int) waveArea.getCentreY(), waveArea.getX(), waveArea.getRight());
+    g.drawHorizontalLine((int) offsetArea.getY(), offsetArea.getX(), offsetArea.getRight());
+
+    int numColumns = juce::jmin(historySize, (int) waveArea.getWidth());
+
+    // the offset lane fits the deepest offset on screen, the wave lane is fixed at +-1
+    float deepest = -1.0f;
+    for (int age = 0; age < numColumns; ++age)
+        deepest = juce::jmin(deepest, getFrame(age).offsetMin);
+
+    auto waveY = [&](float value) {
+        return waveArea.getCentreY() - juce::jlimit(-1.0f, 1.0f, value) * waveArea.getHeight() * 0.5f;
+    };
+    auto offsetY = [&](float value) {
+        return offsetArea.getY() + value / deepest * offsetArea.getHeight();
+    };
+
+    // at least a pixel tall, so flat stretches still show
+    auto column = [&](float x, float top, float bottom) {
+        g.drawVerticalLine((int) x, top, juce::jmax(bottom, top + 1.0f));
+    };
+
+    for (int age = 0; age < numColumns; ++age) {
+        const auto& frame = getFrame(age);
+        float x = waveArea.getRight() - 1.0f - (float) age;
+
+        g.setColour(Palette::overlay2.withAlpha(0.6f));
+        column(x, waveY(frame.dryMax), waveY(frame.dryMin));
+        g.setColour(Palette::yellow.withAlpha(0.8f));
+        column(x, waveY(frame.wetMax), waveY(frame.wetMin));
+        g.setColour(Palette::sky.withAlpha(0.8f));
+        column(x, offsetY(frame.offsetMax), offsetY(frame.offsetMin));
+    }
+
+    g.setColour(Palette::text);
+    g.setFont(12.0f);
+    g.drawText("In / Out", waveArea.reduced(4.0f), juce::Justification::topLeft, false);
+    g.drawText("Offset " + juce::String(juce::roundToInt(-deepest)) + " samples", offsetArea.reduced(4.0f), juce::Justification::bottomLeft, false);
+}
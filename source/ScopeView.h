@@ -0,0 +1,35 @@
+#pragma once
+
+#include "PluginProcessor.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
+
+// the input against what we make of it, with the read offset underneath. it drains the processor's ScopeFeed into
+// a history of decimated frames and draws one frame per pixel column, newest on the right, so a paint is a few
+// vertical lines per column however long the audio behind it was
+class ScopeView : public juce::Component, private juce::Timer {
+public:
+    explicit ScopeView(PluginProcessor& processor);
+    ~ScopeView() override;
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    static constexpr int MAX_HISTORY = 2048;
+
+    PluginProcessor& processorRef;
+    // a ring of the newest frames, historyStart is the oldest
+    std::vector<ScopeFeed::Frame> history;
+    int historyStart = 0;
+    int historySize = 0;
+    // what the timer pulls into before it goes in the ring
+    std::vector<ScopeFeed::Frame> incoming;
+
+    const ScopeFeed::Frame& getFrame(int age) const {
+        return history[static_cast<size_t>((historyStart + historySize - 1 - age) % MAX_HISTORY)];
+    }
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeView)
+};
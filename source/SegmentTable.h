@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+// the control node curve compiled into flat arrays so a lookup is a search over breakpoints plus one multiply-add
+class SegmentTable {
+public:
+    SegmentTable() = default;
+
+    // ui thread - nodes must already be sorted by x
+    void compile(const std::vector<juce::Point<float>>& nodes);
+
+    int getNumSegments() const { return numSegments; }
+
+    // O(log n) - picks the first segment containing x, or segment 0 if x is outside the curve
+    int findSegment(double x) const;
+
+    // checks the cursor's segment and the one after it before falling back to a binary search.
+    // phase mostly moves forward so this is usually a couple of compares
+    int findSegment(double x, int& cursor) const;
+
+    float evaluate(double x) const;
+    float evaluate(double x, int& cursor) const;
+
+    // the curve over [0, 1] as straight pieces in order, callback(x1, x2, slope, intercept), before the clamp
+    // evaluate() applies. outside the nodes that's segment 0 carried on, same as a lookup there
+    template <typename Callback>
+    void forEachPiece(Callback&& callback) const;
+
+private:
+    // breakpoints, numSegments + 1 of them
+    std::vector<float> xs;
+    // numSegments + 1 entries, the last one repeats segment 0 so a failed search needs no special case
+    std::vector<double> slopes;
+    std::vector<double> intercepts;
+    int numSegments = 0;
+
+    float evaluateSegment(int segment, double x) const {
+        auto value = (float) (intercepts[segment] + slopes[segment] * x);
+        return juce::jlimit(0.0f, 1.0f, value);
+    }
+};
+
+inline void SegmentTable::compile(const std::vector<juce::Point<float>>& nodes) {
+    xs.clear();
+    slopes.clear();
+    intercepts.clear();
+    numSegments = nodes.size() < 2 ? 0 : (int) nodes.size() - 1;
+
+    if (numSegments == 0)
+        return;
+
+    xs.reserve(nodes.size());
+    slopes.reserve(nodes.size());
+    intercepts.reserve(nodes.size());
+
+    for (const auto& node : nodes)
+        xs.push_back(node.x);
+
+    for (int i = 0; i < numSegments; ++i) {
+        double x1 = nodes[i].x;
+        double y1 = nodes[i].y;
+        double x2 = nodes[i + 1].x;
+        double y2 = nodes[i + 1].y;
+
+        // vertical segments hold their first value, same as the old t = 0 case
+        double slope = x1 == x2 ? 0.0 : (y2 - y1) / (x2 - x1);
+        slopes.push_back(slope);
+        intercepts.push_back(y1 - slope * x1);
+    }
+
+    slopes.push_back(slopes.front());
+    intercepts.push_back(intercepts.front());
+}
+
+inline int SegmentTable::findSegment(double x) const {
+    // first segment whose end is >= x; if there isn't one we land on the sentinel which mirrors segment 0
+    auto first = xs.begin() + 1;
+    auto it = std::lower_bound(first, xs.end(), x, [](float breakpoint, double value) { return breakpoint < value; });
+    return (int) (it - first);
+}
+
+inline int SegmentTable::findSegment(double x, int& cursor) const {
+    if (cursor >= 0 && cursor < numSegments) {
+        if (xs[cursor] < x && x <= xs[cursor + 1])
+            return cursor;
+
+        int next = cursor + 1;
+        if (next < numSegments && xs[next] < x && x <= xs[next + 1]) {
+            cursor = next;
+            return next;
+        }
+    }
+
+    cursor = findSegment(x);
+    return cursor;
+}
+
+inline float SegmentTable::evaluate(double x) const {
+    if (numSegments == 0)
+        return 0.5f;
+
+    return evaluateSegment(findSegment(x), x);
+}
+
+inline float SegmentTable::evaluate(double x, int& cursor) const {
+    if (numSegments == 0)
+        return 0.5f;
+
+    return evaluateSegment(findSegment(x, cursor), x);
+}
+
+template <typename Callback>
+void SegmentTable::forEachPiece(Callback&& callback) const {
+    if (numSegments == 0) {
+        callback(0.0, 1.0, 0.0, 0.5);
+        return;
+    }
+
+    double start = 0.0;
+    auto piece = [&](double end, int segment) {
+        end = std::clamp(end, start, 1.0);
+        if (end > start)
+            callback(start, end, slopes[segment], intercepts[segment]);
+        start = end;
+    };
+
+    piece(xs[0], 0);
+    for (int i = 0; i < numSegments; ++i)
+        piece(xs[i + 1], i);
+    piece(1.0, 0);
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+// a parameter as the audio thread sees it: the raw atomic, looked up once, and the value we're actually using,
+// gliding towards it over a fixed time no matter how the host cuts up its blocks. each stretch of samples is
+// rendered once into a preallocated control buffer the dsp reads from, and while nothing is moving the buffer
+// is left as it is
+class SmoothedParameter {
+public:
+    enum class Shape { linear, exponential };
+
+    // once, before anything else
+    void attach(std::atomic<float>* newRaw) { raw = newRaw; }
+
+    // allocates - maxSamples is the longest render() we'll be asked for. jumps straight to the parameter's value
+    void prepare(double sampleRate, int maxSamples);
+
+    // audio thread - the rate render() counts samples at. a glide in flight starts over at the new rate
+    void setSampleRate(double newSampleRate);
+
+    // audio thread - takes effect from the next change of target. linear gets there in exactly seconds,
+    // exponential is within 0.1% by then
+    void setSmoothing(Shape newShape, double newSeconds);
+
+    // audio thread - picks up a new value from the parameter, if there is one
+    void update();
+
+    // audio thread - numSamples of the glide, at most prepare()'s maxSamples. the pointer is good until the next call
+    const float* render(int numSamples);
+
+    // audio thread - moves the glide on without rendering, for stretches nobody is going to hear
+    void skip(int numSamples);
+
+    float getCurrent() const { return current; }
+    float getTarget() const { return target; }
+    bool isSmoothing() const { return current != target; }
+
+private:
+    // close enough to stop gliding and land on the target
+    static constexpr float SNAP = 1.0e-5f;
+
+    std::atomic<float>* raw = nullptr;
+    std::vector<float> buffer;
+    // the first filledSamples of buffer all hold filledValue, so a constant render() can often skip the fill
+    int filledSamples = 0;
+    float filledValue = 0.0f;
+
+    double sampleRate = 44100.0;
+    Shape shape = Shape::linear;
+    double seconds = 0.0;
+
+    float current = 0.0f;
+    float target = 0.0f;
+    // the shape of the glide in flight, which a setSmoothing() halfway through leaves alone
+    Shape glideShape = Shape::linear;
+    // linear
+    float step = 0.0f;
+    int remaining = 0;
+    // exponential, what's left of the distance after one sample
+    float coefficient = 0.0f;
+
+    void start();
+    void land() {
+        current = target;
+        remaining = 0;
+    }
+};
+
+inline void SmoothedParameter::prepare(double newSampleRate, int maxSamples) {
+    buffer.assign(static_cast<size_t>(maxSamples), 0.0f);
+    filledSamples = 0;
+    sampleRate = newSampleRate;
+    target = raw->load(std::memory_order_relaxed);
+    land();
+}
+
+inline void SmoothedParameter::setSampleRate(double newSampleRate) {
+    if (newSampleRate == sampleRate)
+        return;
+
+    sampleRate = newSampleRate;
+    if (isSmoothing())
+        start();
+}
+
+inline void SmoothedParameter::setSmoothing(Shape newShape, double newSeconds) {
+    shape = newShape;
+    seconds = newSeconds;
+}
+
+inline void SmoothedParameter::update() {
+    float newTarget = raw->load(std::memory_order_relaxed);
+    if (newTarget == target)
+        return;
+
+    target = newTarget;
+    start();
+}
+
+inline void SmoothedParameter::start() {
+    int numSteps = static_cast<int>(std::round(seconds * sampleRate));
+    if (numSteps <= 0) {
+        land();
+        return;
+    }
+
+    glideShape = shape;
+    if (glideShape == Shape::linear) {
+        remaining = numSteps;
+        step = (target - current) / static_cast<float>(numSteps);
+    } else {
+        // 0.1% left after numSteps
+        coefficient = static_cast<float>(std::exp(std::log(0.001) / numSteps));
+    }
+}
+
+inline const float* SmoothedParameter::render(int numSamples) {
+    jassert(numSamples <= static_cast<int>(buffer.size()));
+    float* values = buffer.data();
+
+    if (!isSmoothing()) {
+        if (filledValue != current || filledSamples < numSamples) {
+            int from = filledValue == current ? filledSamples : 0;
+            std::fill(values + from, values + numSamples, current);
+            filledValue = current;
+            filledSamples = numSamples;
+        }
+        return values;
+    }
+
+    filledSamples = 0;
+
+    if (glideShape == Shape::linear) {
+        int numSteps = std::min(numSamples, remaining);
+        for (int i = 0; i < numSteps; ++i)
+            values[i] = current + step * static_cast<float>(i + 1);
+
+        remaining -= numSteps;
+        if (remaining == 0)
+            land();
+        else
+            current += step * static_cast<float>(numSteps);
+
+        std::fill(values + numSteps, values + numSamples, current);
+    } else {
+        for (int i = 0; i < numSamples; ++i) {
+            current = target + (current - target) * coefficient;
+            if (std::abs(target - current) < SNAP)
+                land();
+            values[i] = current;
+        }
+    }
+
+    return values;
+}
+
+inline void SmoothedParameter::skip(int numSamples) {
+    if (!isSmoothing())
+        return;
+
+    if (glideShape == Shape::linear) {
+        int numSteps = std::min(numSamples, remaining);
+        remaining -= numSteps;
+        if (remaining == 0)
+            land();
+        else
+            current += step * static_cast<float>(numSteps);
+    } else {
+        current = target + (current - target) * std::pow(coefficient, static_cast<float>(numSamples));
+        if (std::abs(target - current) < SNAP)
+            land();
+    }
+}
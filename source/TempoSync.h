@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+// the lfo locked to the host's transport instead of a midi note. a cycle lasts one note value (scaled by the
+// numerator/denominator ratio like a note's frequency is) and the phase is read off the ppq position, so it
+// lines up with the beat however the transport got there. in between the oscillator just runs at the tempo,
+// and only jumps back onto the transport when that jumps: a locate, a loop wrapping round, a new division.
+// all of that is worked out once per block, the oscillator does the per-sample part as usual
+class TempoSync {
+public:
+    struct Division {
+        const char* name;
+        double length;
+        // bars follow the host's time signature, everything else is in quarter notes
+        bool inBars;
+    };
+
+    static constexpr std::array<Division, 15> DIVISIONS { {
+        { "4 Bars", 4.0, true },
+        { "2 Bars", 2.0, true },
+        { "1 Bar", 1.0, true },
+        { "1/2", 2.0, false },
+        { "1/2 Dotted", 3.0, false },
+        { "1/4", 1.0, false },
+        { "1/4 Dotted", 1.5, false },
+        { "1/4 Triplet", 2.0 / 3.0, false },
+        { "1/8", 0.5, false },
+        { "1/8 Dotted", 0.75, false },
+        { "1/8 Triplet", 1.0 / 3.0, false },
+        { "1/16", 0.25, false },
+        { "1/16 Dotted", 0.375, false },
+        { "1/16 Triplet", 1.0 / 6.0, false },
+        { "1/32", 0.125, false },
+    } };
+    static constexpr int DEFAULT_DIVISION = 5;
+
+    static juce::StringArray getDivisionNames() {
+        juce::StringArray names;
+        for (const auto& division : DIVISIONS)
+            names.add(division.name);
+        return names;
+    }
+
+    // a phase the oscillator has to jump to, host samples into the block
+    struct Resync {
+        int sample;
+        double phase;
+    };
+
+    // forget where the transport was, so the next block lands on it whatever it says
+    void reset() { synced = false; }
+
+    // audio thread, once per host block - where the host says we are. a playhead that doesn't know leaves
+    // us running free at the last tempo we heard (120 to start with)
+    void setPosition(const juce::Optional<juce::AudioPlayHead::PositionInfo>& position);
+
+    // audio thread, for each piece of the host block in order, before rendering it
+    void beginBlock(int divisionIndex, double ratio, int numSamples, double sampleRate);
+
+    // whether the transport was rolling at the last setPosition()
+    bool isPlaying() const { return playing; }
+
+    // cycles per second at the current tempo
+    double getFrequency() const { return bpm / 60.0 * cyclesPerBeat; }
+
+    // what beginBlock() found, in sample order. at most one at the start for a jump and one where a loop wraps
+    int getNumResyncs() const { return numResyncs; }
+    const Resync& getResync(int index) const { return resyncs[static_cast<size_t>(index)]; }
+
+private:
+    // the host's last word, ppq in quarter notes
+    double bpm = 120.0;
+    double beatsPerBar = 4.0;
+    double ppq = 0.0;
+    bool playing = false;
+    bool looping = false;
+    double loopStart = 0.0;
+    double loopEnd = 0.0;
+    // how far into the host block the next beginBlock() is, when a big block gets split
+    int samplesIntoHostBlock = 0;
+
+    double cyclesPerBeat = 1.0;
+    // where the next block starts if nothing jumps
+    double expectedPpq = 0.0;
+    bool synced = false;
+
+    std::array<Resync, 2> resyncs {};
+    int numResyncs = 0;
+
+    double getPhaseAt(double beats) const {
+        double cycles = beats * cyclesPerBeat;
+        return cycles - std::floor(cycles);
+    }
+};
+
+inline void TempoSync::setPosition(const juce::Optional<juce::AudioPlayHead::PositionInfo>& position) {
+    samplesIntoHostBlock = 0;
+    playing = false;
+    looping = false;
+
+    if (!position.hasValue())
+        return;
+
+    if (auto hostBpm = position->getBpm(); hostBpm.hasValue() && *hostBpm > 0.0)
+        bpm = *hostBpm;
+
+    if (auto signature = position->getTimeSignature(); signature.hasValue() && signature->numerator > 0 && signature->denominator > 0)
+        beatsPerBar = signature->numerator * 4.0 / signature->denominator;
+
+    auto hostPpq = position->getPpqPosition();
+    if (!hostPpq.hasValue())
+        return;
+
+    ppq = *hostPpq;
+    playing = position->getIsPlaying();
+
+    auto loopPoints = position->getLoopPoints();
+    looping = position->getIsLooping() && loopPoints.hasValue() && loopPoints->ppqEnd > loopPoints->ppqStart;
+    if (looping) {
+        loopStart = loopPoints->ppqStart;
+        loopEnd = loopPoints->ppqEnd;
+    }
+}
+
+inline void TempoSync::beginBlock(int divisionIndex, double ratio, int numSamples, double sampleRate) {
+    numResyncs = 0;
+
+    const auto& division = DIVISIONS[static_cast<size_t>(juce::jlimit(0, static_cast<int>(DIVISIONS.size()) - 1, divisionIndex))];
+    double beatsPerCycle = division.inBars ? division.length * beatsPerBar : division.length;
+    double newCyclesPerBeat = ratio / beatsPerCycle;
+
+    double beatsPerSample = sampleRate > 0.0 ? bpm / (60.0 * sampleRate) : 0.0;
+    double blockPpq = ppq + samplesIntoHostBlock * beatsPerSample;
+    samplesIntoHostBlock += numSamples;
+
+    if (!playing || beatsPerSample <= 0.0) {
+        // stopped, keep going at the tempo from wherever we are and catch up when it starts
+        cyclesPerBeat = newCyclesPerBeat;
+        synced = false;
+        return;
+    }
+
+    // hosts round their positions, so anything within a sample of where we expected counts as carrying on.
+    // a tempo ramp drifts a little further each block and gets nudged back the same way
+    bool jumped = !synced || newCyclesPerBeat != cyclesPerBeat || std::abs(blockPpq - expectedPpq) > beatsPerSample;
+    cyclesPerBeat = newCyclesPerBeat;
+    synced = true;
+
+    if (jumped)
+        resyncs[static_cast<size_t>(numResyncs++)] = { 0, getPhaseAt(blockPpq) };
+
+    double blockEndPpq = blockPpq + numSamples * beatsPerSample;
+    expectedPpq = blockEndPpq;
+
+    // a loop that wraps partway through the block has its start land on the sample it belongs to. hosts that
+    // split their blocks at the loop end show up as a jump at the start of the next one instead
+    if (looping && blockPpq < loopEnd && blockEndPpq > loopEnd) {
+        int sample = static_cast<int>(std::ceil((loopEnd - blockPpq) / beatsPerSample));
+        if (sample < numSamples) {
+            double overshoot = sample * beatsPerSample - (loopEnd - blockPpq);
+            resyncs[static_cast<size_t>(numResyncs++)] = { sample, getPhaseAt(loopStart + overshoot) };
+            expectedPpq = loopStart + (blockEndPpq - loopEnd);
+        }
+    }
+}
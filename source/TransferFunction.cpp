@@ -3,57 +3,140 @@
 #include <cmath>
 
 TransferFunction::TransferFunction()
-    : nodeBuffer(std::vector<juce::Point<float>> { { 0.0f, 0.0f }, { 1.0f, 1.0f } }) {
+    : juce::Thread("Band-limited curve"), controlNodes { { 0.0f, 0.0f }, { 1.0f, 1.0f } } {
+    uiTable.compile(controlNodes);
+    audioTable.setAll({ uiTable, 0 });
+    pendingNodes.setAll(controlNodes);
+
+    BandLimitedCurve curve;
+    curve.build(uiTable, 0);
+    bandLimited.setAll(curve);
+
+    startThread(juce::Thread::Priority::low);
 }
 
-float TransferFunction::getRawValue(double phase) {
-    const auto& nodes = nodeBuffer.read();
-    if (nodes.size() < 2)
-        return 0.5f;
+TransferFunction::~TransferFunction() {
+    // run() sleeps until notified, so wake it to see the exit flag
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
 
-    phase = std::fmod(phase, 1.0);
-    if (phase < 0.0)
-        phase += 1.0;
+// phase must be in [0, 1) and sync positive, so flooring is enough to wrap
+float TransferFunction::applyDepth(const SegmentTable& table, double phase, float depth, float sync, int& cursor) {
+    auto syncPhase = phase * sync;
+    syncPhase -= std::floor(syncPhase);
 
-    size_t segmentIndex = 0;
-    for (size_t j = 0; j < nodes.size() - 1; ++j) {
-        if (phase >= nodes[j].x && phase <= nodes[j + 1].x) {
-            segmentIndex = j;
-            break;
-        }
-    }
+    return applyDepth(table.evaluate(syncPhase, cursor), phase, depth);
+}
 
-    float x1 = nodes[segmentIndex].x;
-    float y1 = nodes[segmentIndex].y;
-    float x2 = nodes[segmentIndex + 1].x;
-    float y2 = nodes[segmentIndex + 1].y;
+float TransferFunction::applyDepth(float rawValue, double phase, float depth) {
+    float result = std::lerp((float) phase, rawValue, depth);
+    return juce::jlimit(0.0f, 1.0f, result);
+}
 
-    float t = x1 == x2 ? 0.0f : (float) ((phase - x1) / (x2 - x1));
-    float value = y1 + (y2 - y1) * t;
+float TransferFunction::getRawValue(double phase) const {
+    phase = std::fmod(phase, 1.0);
+    if (phase < 0.0)
+        phase += 1.0;
 
-    return juce::jlimit(0.0f, 1.0f, value);
+    return uiTable.evaluate(phase);
 }
 
-float TransferFunction::getValue(double phase, float depth, float sync) {
+float TransferFunction::getValue(double phase, float depth, float sync) const {
     phase = std::fmod(phase, 1.0);
     if (phase < 0.0)
         phase += 1.0;
 
-    auto syncPhase = std::fmod(phase * sync, 1.0);
-    if (syncPhase < 0.0)
-        syncPhase += 1.0;
+    int cursor = 0;
+    return applyDepth(uiTable, phase, depth, sync, cursor);
+}
 
-    float rawValue = getRawValue(syncPhase);
+void TransferFunction::getValues(const double* phases, const float* depths, const float* syncs, double periodSamples, float* dest, int numSamples) {
+    const auto& compiled = audioTable.read();
+    const auto& chain = bandLimited.read();
 
-    float result = std::lerp((float) phase, rawValue, depth);
-    return juce::jlimit(0.0f, 1.0f, result);
+    if (chain.getGeneration() != compiled.generation || periodSamples <= 0.0) {
+        // the chain is still being built for these nodes
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = applyDepth(compiled.table, phases[i], depths[i], syncs[i], audioCursor);
+        return;
+    }
+
+    // sync only moves while it's ramping, so the level is worked out again only when it changes
+    float levelSync = -1.0f;
+    double levelPosition = -1.0;
+
+    for (int i = 0; i < numSamples; ++i) {
+        if (syncs[i] != levelSync) {
+            levelSync = syncs[i];
+            levelPosition = BandLimitedCurve::getLevelPosition(levelSync / periodSamples);
+        }
+
+        auto syncPhase = phases[i] * syncs[i];
+        syncPhase -= std::floor(syncPhase);
+
+        // between two levels, or between the exact curve and level 0, crossfade so a sync ramp doesn't step
+        float rawValue;
+        if (levelPosition <= -1.0) {
+            rawValue = compiled.table.evaluate(syncPhase, audioCursor);
+        } else if (levelPosition < 0.0) {
+            float exact = compiled.table.evaluate(syncPhase, audioCursor);
+            rawValue = std::lerp(exact, chain.evaluate(0, syncPhase), (float) (levelPosition + 1.0));
+        } else {
+            int level = static_cast<int>(levelPosition);
+            float frac = static_cast<float>(levelPosition - level);
+            rawValue = chain.evaluate(level, syncPhase);
+            if (frac > 0.0f)
+                rawValue = std::lerp(rawValue, chain.evaluate(level + 1, syncPhase), frac);
+        }
+
+        dest[i] = applyDepth(rawValue, phases[i], depths[i]);
+    }
 }
 
 void TransferFunction::setControlNodes(const std::vector<juce::Point<float>>& nodes) {
-    if (!nodes.empty()) {
-        auto& buffer = nodeBuffer.write();
-        buffer = nodes;
-        std::stable_sort(buffer.begin(), buffer.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
-        nodeBuffer.mark_dirty();
+    if (nodes.empty())
+        return;
+
+    controlNodes = nodes;
+    std::stable_sort(controlNodes.begin(), controlNodes.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
+    uiTable.compile(controlNodes);
+
+    // the back slot keeps its capacity, so once it's seen a curve this size compiling doesn't allocate either
+    int generation = requestedGeneration.load(std::memory_order_relaxed) + 1;
+    auto& compiled = audioTable.write();
+    compiled.table.compile(controlNodes);
+    compiled.generation = generation;
+    audioTable.publish();
+
+    pendingNodes.write() = controlNodes;
+    pendingNodes.publish();
+    requestedGeneration.store(generation, std::memory_order_release);
+    notify();
+}
+
+bool TransferFunction::waitForBandLimited(int timeoutMs) const {
+    auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+    while (builtGeneration.load(std::memory_order_acquire) != requestedGeneration.load(std::memory_order_acquire)) {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+        juce::Thread::sleep(1);
+    }
+    return true;
+}
+
+void TransferFunction::run() {
+    while (!threadShouldExit()) {
+        // a few quick edits in a row only need building once, for the newest
+        int generation = requestedGeneration.load(std::memory_order_acquire);
+        if (generation != builtGeneration.load(std::memory_order_relaxed)) {
+            buildTable.compile(pendingNodes.read());
+            bandLimited.write().build(buildTable, generation);
+            bandLimited.publish();
+            builtGeneration.store(generation, std::memory_order_release);
+        }
+
+        wait(-1);
     }
 }
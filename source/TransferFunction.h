@@ -1,25 +1,71 @@
 #pragma once
 
-#include "DoubleBuffer.h"
+#include "BandLimitedCurve.h"
+#include "SegmentTable.h"
+#include "TripleBuffer.h"
 #include <algorithm>
+#include <atomic>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <vector>
 
-class TransferFunction {
+// the curve, for the ui exactly and for the audio thread band-limited to how fast it's being played.
+// new nodes reach the audio thread straight away as a SegmentTable, and a background thread follows up
+// with the BandLimitedCurve chain. until that's caught up the audio thread reads the exact curve
+class TransferFunction : private juce::Thread {
 public:
     TransferFunction();
+    ~TransferFunction() override;
 
-    // audio thread ideally
-    float getValue(double phase, float depth, float sync = 1.0f);
-    float getRawValue(double phase);
+    // ui thread
+    float getValue(double phase, float depth, float sync = 1.0f) const;
+    float getRawValue(double phase) const;
 
-    // ui thread only
+    // audio thread - same as getValue() for a whole block, from the last curve the ui published. periodSamples
+    // is how long one cycle of phase takes, which with sync decides how many harmonics fit below nyquist.
+    // phases must already be wrapped into [0, 1)
+    void getValues(const double* phases, const float* depths, const float* syncs, double periodSamples, float* dest, int numSamples);
+
+    // ui thread only - sorts, compiles and publishes to the audio thread, then has the band-limited
+    // chain rebuilt in the background
     void setControlNodes(const std::vector<juce::Point<float>>& nodes);
 
-    DoubleBuffer<std::vector<juce::Point<float>>>& nodes() {
-        return nodeBuffer;
+    // not audio thread - blocks until the band-limited chain matches the last setControlNodes(), for
+    // offline renders that set a curve and start straight away. false if it timed out
+    bool waitForBandLimited(int timeoutMs = 1000) const;
+
+    // any thread - goes up by one with every setControlNodes(), so a ui can tell the curve changed under it
+    int getNodeGeneration() const { return requestedGeneration.load(std::memory_order_acquire); }
+
+    // ui thread only
+    const std::vector<juce::Point<float>>& getControlNodes() const {
+        return controlNodes;
     }
 
 private:
-    DoubleBuffer<std::vector<juce::Point<float>>> nodeBuffer;
+    // the ui's copy of the curve, which is also what it draws from
+    std::vector<juce::Point<float>> controlNodes;
+    SegmentTable uiTable;
+
+    // compiled on the ui thread, only ever swapped on the audio thread
+    struct CompiledCurve {
+        SegmentTable table;
+        int generation = 0;
+    };
+    TripleBuffer<CompiledCurve> audioTable;
+    int audioCursor = 0;
+
+    // nodes on their way from the ui to the background thread
+    TripleBuffer<std::vector<juce::Point<float>>> pendingNodes;
+    std::atomic<int> requestedGeneration { 0 };
+    std::atomic<int> builtGeneration { 0 };
+    // built on the background thread, only ever swapped on the audio thread
+    TripleBuffer<BandLimitedCurve> bandLimited;
+    SegmentTable buildTable;
+
+    void run() override;
+
+    static float applyDepth(const SegmentTable& table, double phase, float depth, float sync, int& cursor);
+    static float applyDepth(float rawValue, double phase, float depth);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransferFunction)
 };
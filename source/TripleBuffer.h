@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+
+// one writer thread, one reader thread, neither ever waits.
+// the writer fills its back slot and publishes it by swapping it with the middle slot, the reader
+// takes the middle slot by swapping it with its front slot. slots only change hands, nothing is copied,
+// so the reader never allocates or frees even when T owns memory - that all happens on the writer's side
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& initialValue) {
+        setAll(initialValue);
+    }
+
+    // writer thread - the slot to fill before publish(). it holds whatever was published two or
+    // more times ago, so overwrite it completely
+    T& write() {
+        return buffers[back];
+    }
+
+    // writer thread
+    void publish() {
+        int previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX;
+    }
+
+    // reader thread - the latest published value, stays put until the next read()
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            int previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & INDEX;
+        }
+        return buffers[front];
+    }
+
+    // set every slot to the same value - only while neither side is running
+    void setAll(const T& value) {
+        for (auto& buffer : buffers)
+            buffer = value;
+        middle.store(MIDDLE_START, std::memory_order_release);
+        front = FRONT_START;
+        back = BACK_START;
+    }
+
+private:
+    static constexpr int INDEX = 3;
+    static constexpr int FRESH = 4;
+    static constexpr int FRONT_START = 0;
+    static constexpr int MIDDLE_START = 1;
+    static constexpr int BACK_START = 2;
+
+    T buffers[3];
+    // reader owned
+    int front = FRONT_START;
+    // writer owned
+    int back = BACK_START;
+    // slot index in the low bits, FRESH set when the writer has published since the last read
+    std::atomic<int> middle { MIDDLE_START };
+};
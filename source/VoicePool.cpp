@@ -0,0 +1,269 @@
+#include "VoicePool.h"
+#include <cmath>
+
+VoicePool::VoicePool() {
+    reset();
+}
+
+void VoicePool::prepare(double newOversampledRate, int maxOversampledBlockSize) {
+    setSampleRate(newOversampledRate);
+
+    auto size = static_cast<size_t>(maxOversampledBlockSize);
+    phaseScratch.resize(size);
+    lfoScratch.resize(size);
+    weightTotals.resize(size);
+
+    reset();
+}
+
+void VoicePool::setSampleRate(double newOversampledRate) {
+    oversampledRate = newOversampledRate;
+    // 5ms fades
+    weightStep = static_cast<float>(1.0 / juce::jmax(1.0, oversampledRate * 0.005));
+
+    for (int voice = 0; voice < MAX_VOICES; ++voice)
+        retune(voice);
+}
+
+void VoicePool::reset() {
+    notes.fill(-1);
+    held.fill(false);
+    latched.fill(false);
+    startOrder.fill(0);
+    weights.fill(0.0f);
+    periods.fill(0.0);
+    pendingResets.fill(false);
+    outgoingNotes.fill(-1);
+    for (auto& phase : phases)
+        phase.reset();
+
+    currentPitchBend = 0.0;
+    nextStartOrder = 0;
+    newestVoice = -1;
+}
+
+bool VoicePool::hasActiveVoices() const {
+    for (int voice = 0; voice < MAX_VOICES; ++voice) {
+        if (notes[voice] >= 0)
+            return true;
+    }
+    return false;
+}
+
+double VoicePool::getLongestPeriodSamples() const {
+    double longest = 0.0;
+    for (int voice = 0; voice < MAX_VOICES; ++voice) {
+        if (notes[voice] >= 0)
+            longest = juce::jmax(longest, periods[voice]);
+        // the note waiting for the fade out needs its room too
+        if (outgoingNotes[voice] >= 0)
+            longest = juce::jmax(longest, getPeriodSamples(notes[voice]));
+    }
+    return longest;
+}
+
+double VoicePool::getNewestPhase() const {
+    return newestVoice >= 0 ? phases[newestVoice].getPhase() : 0.0;
+}
+
+double VoicePool::getNewestFrequency() const {
+    return newestVoice >= 0 && periods[newestVoice] > 0.0 ? oversampledRate / periods[newestVoice] : 0.0;
+}
+
+int VoicePool::findVoiceToClaim() const {
+    // a free voice, otherwise the oldest released one, otherwise steal the oldest held one
+    int oldestReleased = -1;
+    int oldestHeld = -1;
+
+    for (int voice = 0; voice < MAX_VOICES; ++voice) {
+        if (notes[voice] < 0)
+            return voice;
+
+        int& oldest = held[voice] ? oldestHeld : oldestReleased;
+        if (oldest < 0 || startOrder[voice] < startOrder[oldest])
+            oldest = voice;
+    }
+
+    return oldestReleased >= 0 ? oldestReleased : oldestHeld;
+}
+
+void VoicePool::startVoice(int voice, int note) {
+    // the first voice to sound takes over straight away, there's nothing to fade against
+    if (!hasActiveVoices())
+        weights[voice] = 1.0f;
+    // still audible, stolen or not done releasing, so it fades out before the new note takes it over
+    else if (notes[voice] >= 0 && weights[voice] > 0.0f && outgoingNotes[voice] < 0)
+        outgoingNotes[voice] = notes[voice];
+
+    notes[voice] = note;
+    held[voice] = true;
+    latched[voice] = false;
+    startOrder[voice] = nextStartOrder++;
+    pendingResets[voice] = outgoingNotes[voice] < 0;
+    newestVoice = voice;
+    retune(voice);
+}
+
+void VoicePool::releaseNote(int note) {
+    for (int voice = 0; voice < MAX_VOICES; ++voice) {
+        if (notes[voice] != note || !held[voice] || latched[voice])
+            continue;
+
+        bool othersHeld = false;
+        for (int other = 0; other < MAX_VOICES; ++other)
+            othersHeld = othersHeld || (other != voice && held[other]);
+
+        if (othersHeld)
+            held[voice] = false;
+        else
+            latched[voice] = true;
+    }
+}
+
+void VoicePool::retune(int voice) {
+    if (notes[voice] < 0)
+        return;
+
+    // whatever the voice is sounding right now
+    int note = outgoingNotes[voice] >= 0 ? outgoingNotes[voice] : notes[voice];
+    periods[voice] = getPeriodSamples(note);
+    phases[voice].setFrequency(oversampledRate / periods[voice], oversampledRate);
+}
+
+double VoicePool::getPeriodSamples(int note) const {
+    double frequency = 440.0 * std::pow(2.0, (note + currentPitchBend - 69.0) / 12.0) * currentRatio;
+    return oversampledRate / frequency;
+}
+
+void VoicePool::setRatio(double ratio) {
+    if (ratio == currentRatio)
+        return;
+
+    currentRatio = ratio;
+    for (int voice = 0; voice < MAX_VOICES; ++voice)
+        retune(voice);
+}
+
+void VoicePool::processMidiMessage(const juce::MidiMessage& msg) {
+    if (msg.isNoteOn()) {
+        // a latched voice gives way to whatever comes next
+        for (int voice = 0; voice < MAX_VOICES; ++voice) {
+            if (latched[voice]) {
+                latched[voice] = false;
+                held[voice] = false;
+            }
+        }
+
+        startVoice(findVoiceToClaim(), msg.getNoteNumber());
+    } else if (msg.isNoteOff()) {
+        releaseNote(msg.getNoteNumber());
+    } else if (msg.isPitchWheel()) {
+        currentPitchBend = ((msg.getPitchWheelValue() - 8192) / 8192.0) * pitchBendRange;
+        for (int voice = 0; voice < MAX_VOICES; ++voice)
+            retune(voice);
+    }
+}
+
+void VoicePool::renderReadOffsets(TransferFunction& tf, const float* depths, const float* syncs, double* readOffsets, int numSamples) {
+    std::fill(readOffsets, readOffsets + numSamples, 0.0);
+    std::fill(weightTotals.begin(), weightTotals.begin() + numSamples, 0.0f);
+
+    updateVoices(&tf, depths, syncs, readOffsets, numSamples);
+
+    for (int sample = 0; sample < numSamples; ++sample) {
+        if (weightTotals[sample] > 0.0f)
+            readOffsets[sample] /= weightTotals[sample];
+    }
+}
+
+void VoicePool::advance(int numSamples) {
+    updateVoices(nullptr, nullptr, nullptr, nullptr, numSamples);
+}
+
+void VoicePool::updateVoices(TransferFunction* tf, const float* depths, const float* syncs, double* readOffsets, int numSamples) {
+    auto step = [&](int voice, int start, int length, float target) {
+        if (tf != nullptr)
+            renderVoice(voice, *tf, depths, syncs, readOffsets, start, length, target);
+        else
+            skipVoice(voice, length, target);
+    };
+
+    // voice by voice rather than across voices, the table lookup is the cost and it runs over a whole block
+    // of one voice's phases. the loops below are over contiguous samples, so they vectorize that way instead
+    for (int voice = 0; voice < MAX_VOICES; ++voice) {
+        if (notes[voice] < 0)
+            continue;
+
+        // the block is split at note ons, so the start of this render is where phase 0 belongs
+        if (pendingResets[voice]) {
+            phases[voice].reset();
+            pendingResets[voice] = false;
+        }
+
+        int start = 0;
+        if (outgoingNotes[voice] >= 0) {
+            int fadeLength = juce::jmin(numSamples, static_cast<int>(std::ceil(weights[voice] / weightStep)));
+            step(voice, 0, fadeLength, 0.0f);
+            if (weights[voice] > 0.0f)
+                continue;
+
+            // silent now, the new note starts on the next sample
+            outgoingNotes[voice] = -1;
+            phases[voice].reset();
+            retune(voice);
+            start = fadeLength;
+        }
+
+        step(voice, start, numSamples - start, held[voice] ? 1.0f : 0.0f);
+
+        if (!held[voice] && weights[voice] <= 0.0f) {
+            notes[voice] = -1;
+            if (newestVoice == voice)
+                newestVoice = -1;
+        }
+    }
+}
+
+void VoicePool::renderVoice(int voice, TransferFunction& tf, const float* depths, const float* syncs, double* readOffsets, int start, int numSamples, float target) {
+    if (numSamples <= 0)
+        return;
+
+    double period = periods[voice];
+    phases[voice].fill(phaseScratch.data(), numSamples);
+    tf.getValues(phaseScratch.data(), depths + start, syncs + start, period, lfoScratch.data(), numSamples);
+
+    double* offsets = readOffsets + start;
+    float* totals = weightTotals.data() + start;
+    float weight = weights[voice];
+
+    if (weight == target) {
+        // steady voice, no per-sample weight update
+        for (int sample = 0; sample < numSamples; ++sample)
+            offsets[sample] += weight * period * ((double) lfoScratch[sample] - phaseScratch[sample] - 1.0);
+        for (int sample = 0; sample < numSamples; ++sample)
+            totals[sample] += weight;
+    } else {
+        float step = target > weight ? weightStep : -weightStep;
+        for (int sample = 0; sample < numSamples; ++sample) {
+            weight = juce::jlimit(0.0f, 1.0f, weight + step);
+            offsets[sample] += weight * period * ((double) lfoScratch[sample] - phaseScratch[sample] - 1.0);
+            totals[sample] += weight;
+        }
+    }
+
+    weights[voice] = weight;
+}
+
+void VoicePool::skipVoice(int voice, int numSamples, float target) {
+    if (numSamples <= 0)
+        return;
+
+    phases[voice].advance(numSamples);
+
+    // stepped a sample at a time like renderVoice(), so a fade ends on the same sample either way
+    float weight = weights[voice];
+    float step = target > weight ? weightStep : -weightStep;
+    for (int sample = 0; sample < numSamples && weight != target; ++sample)
+        weight = juce::jlimit(0.0f, 1.0f, weight + step);
+    weights[voice] = weight;
+}
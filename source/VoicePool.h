@@ -0,0 +1,85 @@
+#pragma once
+
+#include "PhaseAccumulator.h"
+#include "TransferFunction.h"
+#include <array>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+// polyphonic mode: a fixed set of oscillators, one per held note, whose read offsets are averaged into the
+// one shared delay line. everything is allocated in prepare(), voices are claimed and stolen in place.
+// voices fade their weight in and out so notes coming and going don't step the averaged offset.
+// like the mono path the last note stays latched after its note off, until another note replaces it
+class VoicePool {
+public:
+    static constexpr int MAX_VOICES = 8;
+
+    VoicePool();
+
+    // allocates
+    void prepare(double oversampledRate, int maxOversampledBlockSize);
+    void reset();
+
+    // audio thread - for a change of oversampling factor, voices keep their phase and get retuned
+    void setSampleRate(double oversampledRate);
+
+    // audio thread - note ons claim (or steal) a voice, note offs release them, pitch bend moves them all.
+    // a new voice starts at phase 0 at the start of the next render
+    void processMidiMessage(const juce::MidiMessage& msg);
+
+    // audio thread - retunes every voice for the current ratio
+    void setRatio(double ratio);
+
+    bool hasActiveVoices() const;
+    double getLongestPeriodSamples() const;
+
+    // phase of the newest voice, for the ui
+    double getNewestPhase() const;
+    // and how fast it's going, in hz
+    double getNewestFrequency() const;
+
+    // audio thread - fills readOffsets with the weighted average over voices and advances them all
+    void renderReadOffsets(TransferFunction& tf, const float* depths, const float* syncs, double* readOffsets, int numSamples);
+    // audio thread - moves every voice on by numSamples without rendering anything, fades and takeovers included
+    void advance(int numSamples);
+
+    void setPitchBendRange(double range) { pitchBendRange = range; }
+
+private:
+    // per voice state, kept as parallel arrays so the voice loops stay tight
+    std::array<int, MAX_VOICES> notes;
+    std::array<bool, MAX_VOICES> held;
+    // held past its note off because it was the last one
+    std::array<bool, MAX_VOICES> latched;
+    std::array<uint32_t, MAX_VOICES> startOrder;
+    std::array<float, MAX_VOICES> weights;
+    std::array<double, MAX_VOICES> periods;
+    std::array<bool, MAX_VOICES> pendingResets;
+    // the note a claimed voice was still sounding. it fades out on that first and the new note starts from
+    // phase 0 once it's silent, so taking over an audible voice never jumps its phase
+    std::array<int, MAX_VOICES> outgoingNotes;
+    std::array<PhaseAccumulator, MAX_VOICES> phases;
+
+    std::vector<double> phaseScratch;
+    std::vector<float> lfoScratch;
+    std::vector<float> weightTotals;
+
+    double oversampledRate = 44100.0;
+    float weightStep = 1.0f;
+    double currentPitchBend = 0.0;
+    double pitchBendRange = 48.0;
+    double currentRatio = 1.0;
+    uint32_t nextStartOrder = 0;
+    int newestVoice = -1;
+
+    int findVoiceToClaim() const;
+    void startVoice(int voice, int note);
+    void releaseNote(int note);
+    void retune(int voice);
+    double getPeriodSamples(int note) const;
+    // moves every voice on by numSamples, rendering into readOffsets through tf when it's given
+    void updateVoices(TransferFunction* tf, const float* depths, const float* syncs, double* readOffsets, int numSamples);
+    // one voice's weighted offsets into readOffsets and weightTotals, start samples into the render
+    void renderVoice(int voice, TransferFunction& tf, const float* depths, const float* syncs, double* readOffsets, int start, int numSamples, float target);
+    void skipVoice(int voice, int numSamples, float target);
+};